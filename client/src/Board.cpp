@@ -1,79 +1,270 @@
-#include <SDL2/SDL.h>
-#include <vector>
-#include <iostream>
-#include <cstdlib>
-#include <ctime>
-#include <sstream>
-#include <SDL2/SDL_ttf.h>
+#include <algorithm>
+#include <new>
 #include "Board.h"
+#include "Profiler.h"
 
-Board::Board() 
-    : grid(ROWS, std::vector<int>(COLS, 0)) {
+Board::Board(BoardSize size)
+    : rows(std::clamp(size.rows, 4, MAX_ROWS)),
+      cols(std::clamp(size.cols, 4, MAX_COLS)),
+      fullRow(cols == 64 ? ~0ull : (1ull << cols) - 1),
+      table(nullptr),
+      head(0),
+      stackTop(rows),
+      dirtyTop(rows),
+      dirtyBottom(-1) {
+    if (rows <= INLINE_ROWS) {
+        std::fill_n(inlineRows.begin(), rows, 0);
+        return;
+    }
+    table = makeTable((rows + BLOCK_ROWS - 1) / BLOCK_ROWS);
+    for (int i = 0; i < table->blockCount; ++i) {
+        table->blocks()[i] = makeBlock(std::min(BLOCK_ROWS, rows - i * BLOCK_ROWS));
+    }
+}
+
+Board::Board(const Board& other)
+    : rows(other.rows),
+      cols(other.cols),
+      fullRow(other.fullRow),
+      table(other.table),
+      head(other.head),
+      stackTop(other.stackTop),
+      dirtyTop(other.dirtyTop),
+      dirtyBottom(other.dirtyBottom) {
+    if (table) {
+        table->refs.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        std::copy_n(other.inlineRows.begin(), rows, inlineRows.begin());
+    }
+}
+
+Board& Board::operator=(const Board& other) {
+    if (this == &other) {
+        return *this;
+    }
+    if (other.table) {
+        other.table->refs.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        std::copy_n(other.inlineRows.begin(), other.rows, inlineRows.begin());
+    }
+    release(table);
+    rows = other.rows;
+    cols = other.cols;
+    fullRow = other.fullRow;
+    table = other.table;
+    head = other.head;
+    stackTop = other.stackTop;
+    dirtyTop = other.dirtyTop;
+    dirtyBottom = other.dirtyBottom;
+    return *this;
+}
+
+Board::~Board() {
+    release(table);
 }
 
-const std::vector<std::vector<int>>& Board::getGrid() const {
-    return grid;
+Board::BlockTable* Board::makeTable(int blockCount) {
+    static_assert(sizeof(BlockTable) % alignof(Block*) == 0, "block pointers must follow the header");
+    void* memory = ::operator new(sizeof(BlockTable) + blockCount * sizeof(Block*));
+    BlockTable* table = new (memory) BlockTable;
+    table->refs.store(1, std::memory_order_relaxed);
+    table->blockCount = blockCount;
+    return table;
+}
+
+Board::Block* Board::makeBlock(int size, const Block* source) {
+    static_assert(sizeof(Block) % alignof(uint64_t) == 0, "row masks must follow the header");
+    void* memory = ::operator new(sizeof(Block) + size * sizeof(uint64_t));
+    Block* block = new (memory) Block;
+    block->refs.store(1, std::memory_order_relaxed);
+    block->size = size;
+    if (source) {
+        std::copy_n(source->rows(), size, block->rows());
+    } else {
+        std::fill_n(block->rows(), size, 0);
+    }
+    return block;
+}
+
+void Board::release(BlockTable* table) {
+    if (table && table->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        for (int i = 0; i < table->blockCount; ++i) {
+            release(table->blocks()[i]);
+        }
+        table->~BlockTable();
+        ::operator delete(table);
+    }
+}
+
+void Board::release(Block* block) {
+    if (block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        block->~Block();
+        ::operator delete(block);
+    }
+}
+
+// A reference count of one means no other board can see the memory, so it may be
+// written in place; anything else is copied first.
+Board::Block*& Board::ownBlock(int index) {
+    if (table->refs.load(std::memory_order_acquire) != 1) {
+        BlockTable* copy = makeTable(table->blockCount);
+        for (int i = 0; i < table->blockCount; ++i) {
+            Block* block = table->blocks()[i];
+            block->refs.fetch_add(1, std::memory_order_relaxed);
+            copy->blocks()[i] = block;
+        }
+        release(table);
+        table = copy;
+    }
+
+    Block*& block = table->blocks()[index];
+    if (block->refs.load(std::memory_order_acquire) != 1) {
+        Block* copy = makeBlock(block->size, block);
+        release(block);
+        block = copy;
+    }
+    return block;
+}
+
+void Board::makeWritable(int top, int bottom) {
+    if (!table) {
+        return;
+    }
+    int row = top;
+    while (row <= bottom) {
+        int index = slot(row);
+        ownBlock(index >> BLOCK_SHIFT);
+        // On to the first row of the next block, or of slot 0 where the ring wraps.
+        row += std::min(BLOCK_ROWS - (index & (BLOCK_ROWS - 1)), rows - index);
+    }
+}
+
+Board::GridView Board::getGrid() const {
+    return GridView(*this);
+}
+
+void Board::setRowMask(int row, uint64_t mask) {
+    mask &= fullRow;
+    makeWritable(row, row);
+    rowMask(row) = mask;
+    if (mask) {
+        stackTop = std::min(stackTop, row);
+    }
+    markDirty(row, row);
+}
+
+void Board::markDirty(int top, int bottom) {
+    dirtyTop = std::min(dirtyTop, top);
+    dirtyBottom = std::max(dirtyBottom, bottom);
 }
 
 bool Board::checkCollision(const Tetromino& tetromino, int offsetX, int offsetY) const {
-    const auto& shape = tetromino.getShape();
     const auto& pos = tetromino.getPosition();
+    int x = pos.x + offsetX;
+    int y = pos.y + offsetY;
 
-    for (size_t row = 0; row < shape.size(); ++row) {
-        for (size_t col = 0; col < shape[row].size(); ++col) {
-            if (shape[row][col]) {
-                int newX = pos.x + col + offsetX;
-                int newY = pos.y + row + offsetY;
+    // Shapes have tight bounding boxes, so the box itself tells us about walls and floor.
+    if (x < 0 || x + tetromino.getWidth() > cols || y + tetromino.getHeight() > rows) {
+        return true;
+    }
 
-                if (newX < 0 || newX >= COLS || newY >= ROWS || (newY >= 0 && grid[newY][newX])) {
-                    return true;
-                }
-            }
+    for (int row = 0; row < tetromino.getHeight(); ++row) {
+        int boardRow = y + row;
+        if (boardRow >= 0 && (getRowMask(boardRow) & (static_cast<uint64_t>(tetromino.getRowMask(row)) << x))) {
+            return true;
         }
     }
     return false;
 }
 
 void Board::mergeTetromino(const Tetromino& tetromino) {
-    const auto& shape = tetromino.getShape();
     const auto& pos = tetromino.getPosition();
+    int top = std::max(pos.y, 0);
+    int bottom = pos.y + tetromino.getHeight() - 1;
+    if (bottom < top) {
+        return;
+    }
 
-    for (size_t row = 0; row < shape.size(); ++row) {
-        for (size_t col = 0; col < shape[row].size(); ++col) {
-            if (shape[row][col]) {
-                grid[pos.y + row][pos.x + col] = shape[row][col];
-            }
+    makeWritable(top, bottom);
+    for (int row = top; row <= bottom; ++row) {
+        rowMask(row) |= static_cast<uint64_t>(tetromino.getRowMask(row - pos.y)) << pos.x;
+    }
+    stackTop = std::min(stackTop, top);
+    markDirty(top, bottom);
+}
+
+// Drops every row above `row` by one and leaves an empty row on top. Either the rows
+// above move down, or the rows below move up and the ring turns back by one so the freed
+// slot becomes the new top; whichever side is shorter.
+void Board::removeRow(int row) {
+    // Profiled here rather than in clearLines(), which the bot calls for every candidate.
+    PROFILE_ZONE("Board::removeRow");
+    int to = slot(row);
+    if (row < rows - 1 - row) {
+        makeWritable(0, row);
+        for (int i = row; i > 0; --i) {
+            int from = to == 0 ? rows - 1 : to - 1;
+            slotMask(to) = slotMask(from);
+            to = from;
+        }
+        slotMask(to) = 0;
+    } else {
+        makeWritable(row, rows - 1);
+        for (int i = row; i < rows - 1; ++i) {
+            int from = to == rows - 1 ? 0 : to + 1;
+            slotMask(to) = slotMask(from);
+            to = from;
         }
+        slotMask(to) = 0;
+        head = head == 0 ? rows - 1 : head - 1;
     }
 }
 
 int Board::clearLines() {
     int count = 0;
-    for (int row = ROWS - 1; row >= 0; --row) {
-        bool fullLine = true;
-        for (int col = 0; col < COLS; ++col) {
-            if (!grid[row][col]) {
-                fullLine = false;
-                break;
-            }
-        }
-
-        if (fullLine) {
+    int row = dirtyBottom;
+    int top = dirtyTop;
+    while (row >= top) {
+        if (getRowMask(row) == fullRow) {
+            removeRow(row);
             count++;
-            for (int moveRow = row; moveRow > 0; --moveRow) {
-                grid[moveRow] = grid[moveRow - 1];
-            }
-            grid[0] = std::vector<int>(COLS, 0);
-            ++row;
+            // What was above has moved down one, onto the row just checked.
+            top++;
+        } else {
+            --row;
         }
     }
+    stackTop = std::min(rows, stackTop + count);
+    dirtyTop = rows;
+    dirtyBottom = -1;
     return count;
 }
 
 void Board::clear() {
-    for (int row = 0; row < ROWS; ++row) {
-        for (int col = 0; col < COLS; ++col) {
-            grid[row][col] = 0;
+    // Shared memory is swapped for fresh empty blocks rather than copied and then zeroed.
+    if (!table) {
+        std::fill_n(inlineRows.begin(), rows, 0);
+    } else if (table->refs.load(std::memory_order_acquire) != 1) {
+        BlockTable* fresh = makeTable(table->blockCount);
+        for (int i = 0; i < fresh->blockCount; ++i) {
+            fresh->blocks()[i] = makeBlock(table->blocks()[i]->size);
+        }
+        release(table);
+        table = fresh;
+    } else {
+        for (int i = 0; i < table->blockCount; ++i) {
+            Block*& block = table->blocks()[i];
+            if (block->refs.load(std::memory_order_acquire) != 1) {
+                int size = block->size;
+                release(block);
+                block = makeBlock(size);
+            } else {
+                std::fill_n(block->rows(), block->size, 0);
+            }
         }
     }
-}
\ No newline at end of file
+    head = 0;
+    stackTop = rows;
+    dirtyTop = rows;
+    dirtyBottom = -1;
+}
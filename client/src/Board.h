@@ -1,26 +1,134 @@
 #ifndef BOARD_H
 #define BOARD_H
 
-#include <vector>
-#include <string>
-#include <sstream>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include "Tetromino.h"
 
+// Dimensions of a board; each game picks its own.
+struct BoardSize {
+    int rows;
+    int cols;
+};
+
+// Boards of up to INLINE_ROWS rows keep their rows inline, so copying one is a memcpy that
+// never allocates. Taller boards share their rows between copies copy-on-write, in blocks
+// of BLOCK_ROWS: copying is constant time and never allocates, and a write clones only
+// the block it touches. Either way boards are cheap to save, fork and roll back.
 class Board {
 public:
-    const int ROWS = 20;
-    const int COLS = 10;
-    Board();
+    static constexpr int DEFAULT_ROWS = 20;
+    static constexpr int DEFAULT_COLS = 10;
+    static constexpr int MAX_COLS = 64;
+    static constexpr int MAX_ROWS = 65535;
+    static constexpr BoardSize DEFAULT_SIZE = {DEFAULT_ROWS, DEFAULT_COLS};
+    static constexpr int INLINE_ROWS = 32;
+
+    // Read-only view over a single row mask, indexable like the old vector<int> row.
+    class RowView {
+    public:
+        RowView(uint64_t mask, int cols) : mask(mask), cols(cols) {}
+        int operator[](int col) const { return static_cast<int>((mask >> col) & 1); }
+        int size() const { return cols; }
+
+    private:
+        uint64_t mask;
+        int cols;
+    };
+
+    // Read-only view over the whole board, so grid[row][col] keeps working for renderers.
+    class GridView {
+    public:
+        explicit GridView(const Board& board) : board(board) {}
+        RowView operator[](int row) const { return RowView(board.getRowMask(row), board.cols); }
+        int size() const { return board.rows; }
+
+    private:
+        const Board& board;
+    };
 
-    const std::vector<std::vector<int>>& getGrid() const;
+    // Sizes are clamped to 4..MAX_ROWS rows and 4..MAX_COLS columns.
+    explicit Board(BoardSize size = DEFAULT_SIZE);
+    Board(const Board& other);
+    Board& operator=(const Board& other);
+    ~Board();
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    BoardSize getSize() const { return {rows, cols}; }
+    uint64_t getFullRow() const { return fullRow; }
+    // Rows above this one are all empty; getRows() for an empty board.
+    int getStackTop() const { return stackTop; }
+
+    GridView getGrid() const;
+    uint64_t getRowMask(int row) const {
+        int index = slot(row);
+        return table ? table->blocks()[index >> BLOCK_SHIFT]->rows()[index & (BLOCK_ROWS - 1)] : inlineRows[index];
+    }
+    void setRowMask(int row, uint64_t mask);
 
     bool checkCollision(const Tetromino& tetromino, int offsetX, int offsetY) const;
     void mergeTetromino(const Tetromino& tetromino);
+    // Only rows touched by merges or setRowMask() since the last call can be full, so
+    // only those are checked.
     int clearLines();
     void clear();
 
 private:
-    std::vector<std::vector<int>> grid;
+    static constexpr int BLOCK_SHIFT = 8;
+    static constexpr int BLOCK_ROWS = 1 << BLOCK_SHIFT;
+
+    // Row slots [n * BLOCK_ROWS, n * BLOCK_ROWS + size), shared by every board that holds
+    // a reference to it; only the last block of a board is short. The masks follow the
+    // header in the same allocation.
+    struct Block {
+        std::atomic<int> refs;
+        int size;
+        uint64_t* rows() { return reinterpret_cast<uint64_t*>(this + 1); }
+        const uint64_t* rows() const { return reinterpret_cast<const uint64_t*>(this + 1); }
+    };
+    // The board's list of blocks, also shared between copies; the block pointers follow
+    // the header in the same allocation.
+    struct BlockTable {
+        std::atomic<int> refs;
+        int blockCount;
+        Block** blocks() { return reinterpret_cast<Block**>(this + 1); }
+    };
+
+    int rows;
+    int cols;
+    uint64_t fullRow;
+    // Bit `col` of a row mask is set when that cell is occupied. Row 0, the top, lives in
+    // slot `head`; the rows wrap around the last slot. The slots are inlineRows when table
+    // is null, and the table's blocks otherwise.
+    BlockTable* table;
+    std::array<uint64_t, INLINE_ROWS> inlineRows;
+    int head;
+    int stackTop;
+    // Rows that may have become full, empty when dirtyTop > dirtyBottom.
+    int dirtyTop;
+    int dirtyBottom;
+
+    int slot(int row) const {
+        int index = head + row;
+        return index < rows ? index : index - rows;
+    }
+    uint64_t& slotMask(int index) {
+        return table ? table->blocks()[index >> BLOCK_SHIFT]->rows()[index & (BLOCK_ROWS - 1)] : inlineRows[index];
+    }
+    uint64_t& rowMask(int row) { return slotMask(slot(row)); }
+    // Unshares the table and the blocks holding rows [top, bottom], so rowMask() can write them.
+    void makeWritable(int top, int bottom);
+    Block*& ownBlock(int index);
+    static BlockTable* makeTable(int blockCount);
+    // A block of `size` empty rows, or a copy of `source` when given.
+    static Block* makeBlock(int size, const Block* source = nullptr);
+    // Null tables are inline boards and have nothing to release.
+    static void release(BlockTable* table);
+    static void release(Block* block);
+    void markDirty(int top, int bottom);
+    void removeRow(int row);
 };
 
 #endif
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include "BoardRenderer.h"
+#include "Constants.h"
+
+namespace {
+
+const SDL_Color EMPTY_FILL = {50, 50, 50, 255};
+const SDL_Color EMPTY_OUTLINE = {255, 255, 255, 255};
+const SDL_Color LOCKED_OUTLINE = {200, 200, 200, 255};
+const SDL_Color PIECE_OUTLINE = {255, 255, 255, 255};
+const SDL_Color PANEL_COLOR = {30, 30, 30, 255};
+const SDL_Color BUTTON_COLOR = {100, 100, 100, 255};
+const SDL_Color TEXT_COLOR = {255, 255, 255, 255};
+
+}
+
+BoardRenderer::BoardRenderer(SDL_Renderer* renderer, TextRenderer& text)
+    : renderer(renderer),
+      text(text),
+      background(nullptr),
+      backgroundReady(false) {
+    pieceCells.reserve(MAX_SHAPE_SIZE * MAX_SHAPE_SIZE);
+}
+
+BoardRenderer::~BoardRenderer() {
+    SDL_DestroyTexture(background);
+}
+
+int BoardRenderer::drawCells(const std::vector<SDL_Rect>& cells, SDL_Color fill, SDL_Color outline) {
+    if (cells.empty()) {
+        return 0;
+    }
+    int count = static_cast<int>(cells.size());
+    SDL_SetRenderDrawColor(renderer, fill.r, fill.g, fill.b, fill.a);
+    SDL_RenderFillRects(renderer, cells.data(), count);
+    SDL_SetRenderDrawColor(renderer, outline.r, outline.g, outline.b, outline.a);
+    SDL_RenderDrawRects(renderer, cells.data(), count);
+    return 4;
+}
+
+// Everything that does not depend on game state: empty cells, the score panel and the
+// pause hint. Drawn straight to the screen when render targets are unavailable.
+bool BoardRenderer::updateLayout(const Board& board) {
+    PlayfieldLayout next = PlayfieldLayout::of(board);
+    bool changed = next != layout;
+    layout = next;
+    return changed;
+}
+
+int BoardRenderer::drawBackground() {
+    const int cell = layout.cellSize;
+    std::vector<SDL_Rect> emptyCells;
+    emptyCells.reserve(layout.visibleRows * layout.cols);
+    for (int row = 0; row < layout.visibleRows; ++row) {
+        for (int col = 0; col < layout.cols; ++col) {
+            emptyCells.push_back({layout.x + col * cell, layout.y + row * cell, cell, cell});
+        }
+    }
+    int calls = drawCells(emptyCells, EMPTY_FILL, EMPTY_OUTLINE);
+
+    SDL_Rect scoreBackground = {SCORE_AREA_X, 0, SCORE_AREA_WIDTH, WINDOW_HEIGHT};
+    SDL_SetRenderDrawColor(renderer, PANEL_COLOR.r, PANEL_COLOR.g, PANEL_COLOR.b, PANEL_COLOR.a);
+    SDL_RenderFillRect(renderer, &scoreBackground);
+
+    SDL_Rect pauseButtonRect = {SCORE_AREA_X + (SCORE_AREA_WIDTH - 140) / 2, SCORE_Y + 100, 150, 50};
+    SDL_SetRenderDrawColor(renderer, BUTTON_COLOR.r, BUTTON_COLOR.g, BUTTON_COLOR.b, BUTTON_COLOR.a);
+    SDL_RenderFillRect(renderer, &pauseButtonRect);
+    text.draw(text.getStatic("Pause: P/E", 24, TEXT_COLOR), pauseButtonRect.x + 20, pauseButtonRect.y + 10);
+
+    return calls + 5;
+}
+
+int BoardRenderer::draw(const GameState& state, SDL_Color pieceColor) {
+    int calls = 0;
+    const Board& board = state.getBoard();
+
+    if (updateLayout(board)) {
+        SDL_DestroyTexture(background);
+        background = nullptr;
+        backgroundReady = false;
+    }
+    if (!backgroundReady) {
+        backgroundReady = true;
+        background = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, WINDOW_WIDTH, WINDOW_HEIGHT);
+        if (background && SDL_SetRenderTarget(renderer, background) == 0) {
+            drawBackground();
+            SDL_SetRenderTarget(renderer, nullptr);
+        } else {
+            SDL_DestroyTexture(background);
+            background = nullptr;
+        }
+    }
+
+    if (background) {
+        SDL_RenderCopy(renderer, background, nullptr, nullptr);
+        calls++;
+    } else {
+        calls += drawBackground();
+    }
+
+    const Tetromino& tetromino = state.getCurrentTetromino();
+    const auto& shape = tetromino.getShape();
+    const auto& pos = tetromino.getPosition();
+    const int cell = layout.cellSize;
+    int firstRow = layout.firstVisibleRow(board, tetromino);
+
+    lockedCells.clear();
+    for (int row = 0; row < layout.visibleRows; ++row) {
+        uint64_t mask = board.getRowMask(firstRow + row);
+        for (int col = 0; mask; ++col, mask >>= 1) {
+            if (mask & 1) {
+                lockedCells.push_back({layout.x + col * cell, layout.y + row * cell, cell, cell});
+            }
+        }
+    }
+    calls += drawCells(lockedCells, LOCKED_COLOR, LOCKED_OUTLINE);
+
+    pieceCells.clear();
+    for (int row = 0; row < shape.height; ++row) {
+        int visibleRow = pos.y + row - firstRow;
+        if (visibleRow < 0 || visibleRow >= layout.visibleRows) {
+            continue;
+        }
+        for (int col = 0; col < shape.width; ++col) {
+            if (shape.isFilled(row, col)) {
+                pieceCells.push_back({layout.x + (pos.x + col) * cell, layout.y + visibleRow * cell, cell, cell});
+            }
+        }
+    }
+    calls += drawCells(pieceCells, pieceColor, PIECE_OUTLINE);
+
+    text.draw(text.getValue("Score: ", state.getScore(), 24, TEXT_COLOR), SCORE_AREA_X + (SCORE_AREA_WIDTH / 2) - 50, SCORE_Y);
+    return calls + 1;
+}
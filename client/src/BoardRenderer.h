@@ -0,0 +1,39 @@
+#ifndef BOARD_RENDERER_H
+#define BOARD_RENDERER_H
+
+#include <vector>
+#include <SDL2/SDL.h>
+#include "GameState.h"
+#include "Playfield.h"
+#include "TextRenderer.h"
+
+// Draws a running game with a handful of batched calls: the empty grid and the score
+// panel come from a texture rendered once, and filled cells are gathered into one rect
+// list per color and submitted with SDL_RenderFillRects/SDL_RenderDrawRects.
+class BoardRenderer {
+public:
+    BoardRenderer(SDL_Renderer* renderer, TextRenderer& text);
+    ~BoardRenderer();
+    BoardRenderer(const BoardRenderer&) = delete;
+    BoardRenderer& operator=(const BoardRenderer&) = delete;
+
+    // Returns the number of SDL draw calls issued.
+    int draw(const GameState& state, SDL_Color pieceColor);
+
+private:
+    SDL_Renderer* renderer;
+    TextRenderer& text;
+    SDL_Texture* background;
+    bool backgroundReady;
+    PlayfieldLayout layout;
+
+    std::vector<SDL_Rect> lockedCells;
+    std::vector<SDL_Rect> pieceCells;
+
+    // Returns true when the layout changed and the background must be redrawn.
+    bool updateLayout(const Board& board);
+    int drawBackground();
+    int drawCells(const std::vector<SDL_Rect>& cells, SDL_Color fill, SDL_Color outline);
+};
+
+#endif
@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include "Bot.h"
+
+namespace {
+
+const double LOST_GAME_SCORE = -1e9;
+
+template <typename BoardType>
+Tetromino dropped(const BoardType& board, Tetromino piece) {
+    while (!board.checkCollision(piece, 0, 1)) {
+        piece.move(0, 1);
+    }
+    return piece;
+}
+
+bool sameShape(const ShapeData& a, const ShapeData& b) {
+    if (a.width != b.width || a.height != b.height) {
+        return false;
+    }
+    for (int row = 0; row < a.height; ++row) {
+        if (a.rowMasks[row] != b.rowMasks[row]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+Bot::Bot(const BotWeights& weights, WorkerPool* pool, std::chrono::microseconds budget)
+    : weights(weights),
+      pool(pool),
+      budget(budget) {
+}
+
+// Column heights and holes come from one top-down pass over the row masks, starting at
+// the top of the stack: `covered` accumulates every column that already has a block above
+// the current row.
+template <typename BoardType>
+double Bot::evaluate(const BoardType& board, int lines) const {
+    const int rows = board.getRows();
+    const int cols = board.getCols();
+    int heights[Board::MAX_COLS] = {};
+    int holes = 0;
+    uint64_t covered = 0;
+
+    for (int row = board.getStackTop(); row < rows; ++row) {
+        uint64_t mask = board.getRowMask(row);
+        for (uint64_t tops = mask & ~covered; tops; tops &= tops - 1) {
+            heights[__builtin_ctzll(tops)] = rows - row;
+        }
+        holes += __builtin_popcountll(covered & ~mask);
+        covered |= mask;
+    }
+
+    int aggregateHeight = 0;
+    int bumpiness = 0;
+    for (int col = 0; col < cols; ++col) {
+        aggregateHeight += heights[col];
+        if (col > 0) {
+            bumpiness += std::abs(heights[col] - heights[col - 1]);
+        }
+    }
+
+    return weights.aggregateHeight * aggregateHeight +
+           weights.linesCleared * lines +
+           weights.holes * holes +
+           weights.bumpiness * bumpiness;
+}
+
+// Lists every distinct placement reachable from `start`: rotate in place first (stopping
+// at the first blocked rotation, as the game would), then slide and hard drop.
+template <typename BoardType>
+int Bot::enumerate(const BoardType& board, const Tetromino& start, Candidate* candidates) {
+    int count = 0;
+    Tetromino rotated = start;
+    const ShapeData* seen[ROTATION_COUNT];
+    int seenCount = 0;
+
+    for (int rotations = 0; rotations < ROTATION_COUNT; ++rotations) {
+        if (rotations > 0) {
+            rotated.rotate();
+            if (board.checkCollision(rotated, 0, 0)) {
+                break;
+            }
+        }
+
+        bool duplicate = false;
+        for (int i = 0; i < seenCount && !duplicate; ++i) {
+            duplicate = sameShape(*seen[i], rotated.getShape());
+        }
+        if (duplicate) {
+            continue;
+        }
+        seen[seenCount++] = &rotated.getShape();
+
+        candidates[count++] = {dropped(board, rotated), rotations, 0};
+        for (int direction = -1; direction <= 1; direction += 2) {
+            Tetromino moved = rotated;
+            for (int steps = 1; !board.checkCollision(moved, direction, 0); ++steps) {
+                moved.move(direction, 0);
+                candidates[count++] = {dropped(board, moved), rotations, direction * steps};
+            }
+        }
+    }
+    return count;
+}
+
+template <typename BoardType>
+double Bot::bestFollowUp(const BoardType& board, const Tetromino& next) const {
+    if (board.checkCollision(next, 0, 0)) {
+        return LOST_GAME_SCORE;
+    }
+
+    Candidate candidates[MAX_PLACEMENTS];
+    int count = enumerate(board, next, candidates);
+
+    // Assigning into the same Board reuses its row storage.
+    BoardType after = board;
+    double best = LOST_GAME_SCORE;
+    for (int i = 0; i < count; ++i) {
+        after = board;
+        after.mergeTetromino(candidates[i].piece);
+        int lines = after.clearLines();
+        best = std::max(best, evaluate(after, lines));
+    }
+    return best;
+}
+
+template <typename BoardType>
+double Bot::scoreCandidate(const BoardType& board, const Candidate& candidate, const Tetromino& next) const {
+    BoardType after = board;
+    after.mergeTetromino(candidate.piece);
+    int lines = after.clearLines();
+    return weights.linesCleared * lines + bestFollowUp(after, next);
+}
+
+template <typename BoardType>
+void Bot::scoreInParallel(const BoardType& board, const Candidate* candidates, int count,
+                          const Tetromino& next, double* scores) const {
+    auto deadline = WorkerPool::Clock::now() + budget;
+    pool->parallelFor(count, [&](int i) {
+        scores[i] = WorkerPool::Clock::now() < deadline
+            ? scoreCandidate(board, candidates[i], next)
+            : std::numeric_limits<double>::quiet_NaN();
+    });
+}
+
+template <typename BoardType>
+int Bot::listPlacements(const BoardType& board, const Tetromino& piece, BotMove* moves) {
+    Candidate candidates[MAX_PLACEMENTS];
+    int count = enumerate(board, piece, candidates);
+    for (int i = 0; i < count; ++i) {
+        moves[i] = toMove(candidates[i], 0);
+    }
+    return count;
+}
+
+template <typename BoardType>
+int Bot::placeGreedy(BoardType& board, const Tetromino& piece) const {
+    if (board.checkCollision(piece, 0, 0)) {
+        return -1;
+    }
+
+    Candidate candidates[MAX_PLACEMENTS];
+    int count = enumerate(board, piece, candidates);
+    BoardType after = board;
+    int best = 0;
+    double bestScore = LOST_GAME_SCORE;
+    for (int i = 0; i < count; ++i) {
+        after = board;
+        after.mergeTetromino(candidates[i].piece);
+        int lines = after.clearLines();
+        double score = evaluate(after, lines);
+        if (i == 0 || score > bestScore) {
+            best = i;
+            bestScore = score;
+        }
+    }
+    board.mergeTetromino(candidates[best].piece);
+    return board.clearLines();
+}
+
+BotMove Bot::toMove(const Candidate& candidate, double score) {
+    BotMove move;
+    move.target = candidate.piece;
+    move.score = score;
+    move.valid = true;
+    for (int i = 0; i < candidate.rotations; ++i) {
+        move.commands[move.commandCount++] = Command::Rotate;
+    }
+    for (int i = 0; i < std::abs(candidate.shift); ++i) {
+        move.commands[move.commandCount++] = candidate.shift < 0 ? Command::Left : Command::Right;
+    }
+    move.commands[move.commandCount++] = Command::HardDrop;
+    return move;
+}
+
+BotMove Bot::plan(const GameState& state) const {
+    if (state.isGameOver()) {
+        return BotMove();
+    }
+    Tetromino next = state.makeSpawnTetromino(state.getPieceGenerator().peek(0));
+    return plan(state.getBoard(), state.getCurrentTetromino(), next);
+}
+
+BotMove Bot::plan(const Board& board, const Tetromino& current, const Tetromino& next) const {
+    if (StandardBoard::fits(board)) {
+        return search(StandardBoard(board), current, next);
+    }
+    return search(board, current, next);
+}
+
+template <typename BoardType>
+BotMove Bot::search(const BoardType& board, const Tetromino& current, const Tetromino& next) const {
+    Candidate candidates[MAX_PLACEMENTS];
+    int count = enumerate(board, current, candidates);
+    if (count == 0) {
+        return BotMove();
+    }
+
+    double scores[MAX_PLACEMENTS];
+    bool complete = true;
+    if (pool && count > 1) {
+        scoreInParallel(board, candidates, count, next, scores);
+    } else {
+        auto deadline = WorkerPool::Clock::now() + budget;
+        for (int i = 0; i < count; ++i) {
+            scores[i] = WorkerPool::Clock::now() < deadline
+                ? scoreCandidate(board, candidates[i], next)
+                : std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        complete = complete && scores[i] == scores[i];
+    }
+
+    // Out of time: rank every candidate on the current piece alone so scores stay comparable.
+    if (!complete) {
+        BoardType after = board;
+        for (int i = 0; i < count; ++i) {
+            after = board;
+            after.mergeTetromino(candidates[i].piece);
+            int lines = after.clearLines();
+            scores[i] = evaluate(after, lines);
+        }
+    }
+
+    int best = 0;
+    for (int i = 1; i < count; ++i) {
+        if (scores[i] > scores[best]) {
+            best = i;
+        }
+    }
+
+    return toMove(candidates[best], scores[best]);
+}
+
+template BotMove Bot::search<Board>(const Board&, const Tetromino&, const Tetromino&) const;
+template BotMove Bot::search<StandardBoard>(const StandardBoard&, const Tetromino&, const Tetromino&) const;
+template double Bot::evaluate<Board>(const Board&, int) const;
+template double Bot::evaluate<StandardBoard>(const StandardBoard&, int) const;
+template int Bot::listPlacements<Board>(const Board&, const Tetromino&, BotMove*);
+template int Bot::listPlacements<StandardBoard>(const StandardBoard&, const Tetromino&, BotMove*);
+template int Bot::placeGreedy<Board>(Board&, const Tetromino&) const;
+template int Bot::placeGreedy<StandardBoard>(StandardBoard&, const Tetromino&) const;
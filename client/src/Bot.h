@@ -0,0 +1,94 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include <chrono>
+#include "Board.h"
+#include "Command.h"
+#include "FixedBoard.h"
+#include "GameState.h"
+#include "Tetromino.h"
+#include "WorkerPool.h"
+
+// Weights of the placement heuristic; the defaults are the well-known genetically tuned
+// set for height, lines, holes and bumpiness.
+struct BotWeights {
+    double aggregateHeight = -0.510066;
+    double linesCleared = 0.760666;
+    double holes = -0.35663;
+    double bumpiness = -0.184483;
+};
+
+// A final resting place for a piece plus the inputs that take it there from its
+// current position: rotations, sideways moves, then a hard drop.
+struct BotMove {
+    static constexpr int MAX_COMMANDS = ROTATION_COUNT + Board::MAX_COLS + 1;
+
+    Tetromino target = Tetromino(TetrominoType::I, Position());
+    double score = 0;
+    bool valid = false;
+    Command commands[MAX_COMMANDS] = {};
+    int commandCount = 0;
+};
+
+// Placement search bot. For the current piece it enumerates every placement reachable by
+// rotating in place, sliding sideways and hard dropping, and scores each one by the best
+// follow-up placement of the next piece. With a WorkerPool the candidates are scored in
+// parallel; the time budget caps how long the lookahead may take per piece, and a zero
+// budget skips it, ranking placements on the current piece alone.
+//
+// The search is templated on the board type. Standard 20x10 boards are copied into a
+// StandardBoard first; other sizes search on Board itself.
+class Bot {
+public:
+    static constexpr int MAX_PLACEMENTS = ROTATION_COUNT * Board::MAX_COLS;
+
+    explicit Bot(const BotWeights& weights = BotWeights(), WorkerPool* pool = nullptr,
+                 std::chrono::microseconds budget = std::chrono::microseconds(2000));
+
+    const BotWeights& getWeights() const { return weights; }
+
+    BotMove plan(const GameState& state) const;
+    BotMove plan(const Board& board, const Tetromino& current, const Tetromino& next) const;
+    // plan() on a given board type; instantiated for Board and StandardBoard.
+    template <typename BoardType>
+    BotMove search(const BoardType& board, const Tetromino& current, const Tetromino& next) const;
+
+    // Heuristic value of a board after a placement that cleared `lines` rows; instantiated
+    // for Board and StandardBoard.
+    template <typename BoardType>
+    double evaluate(const BoardType& board, int lines) const;
+
+    // Every distinct resting place of `piece` that plan() considers, with the inputs that
+    // reach it; returns how many were written to `moves` (at most MAX_PLACEMENTS).
+    template <typename BoardType>
+    static int listPlacements(const BoardType& board, const Tetromino& piece, BotMove* moves);
+    // Fast one-piece policy for rollouts: locks `piece` where evaluate() likes it best, with
+    // no lookahead and no time budget, and clears lines. Returns the lines cleared, or -1
+    // when the piece has no room.
+    template <typename BoardType>
+    int placeGreedy(BoardType& board, const Tetromino& piece) const;
+
+private:
+    struct Candidate {
+        Tetromino piece = Tetromino(TetrominoType::I, Position());
+        int rotations = 0;
+        int shift = 0;
+    };
+
+    BotWeights weights;
+    WorkerPool* pool;
+    std::chrono::microseconds budget;
+
+    template <typename BoardType>
+    static int enumerate(const BoardType& board, const Tetromino& start, Candidate* candidates);
+    template <typename BoardType>
+    double bestFollowUp(const BoardType& board, const Tetromino& next) const;
+    template <typename BoardType>
+    double scoreCandidate(const BoardType& board, const Candidate& candidate, const Tetromino& next) const;
+    template <typename BoardType>
+    void scoreInParallel(const BoardType& board, const Candidate* candidates, int count,
+                         const Tetromino& next, double* scores) const;
+    static BotMove toMove(const Candidate& candidate, double score);
+};
+
+#endif
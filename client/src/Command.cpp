@@ -0,0 +1,23 @@
+#include "Command.h"
+
+namespace {
+
+const char* const COMMAND_NAMES[COMMAND_COUNT] = {
+    "LEFT", "RIGHT", "DOWN", "ROTATE", "SPACE", "Pause", "RESTART"
+};
+
+}
+
+bool parseCommand(const std::string& text, Command& command) {
+    for (int i = 0; i < COMMAND_COUNT; ++i) {
+        if (text == COMMAND_NAMES[i]) {
+            command = static_cast<Command>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* commandName(Command command) {
+    return COMMAND_NAMES[static_cast<int>(command)];
+}
@@ -0,0 +1,24 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <cstdint>
+#include <string>
+
+enum class Command : uint8_t {
+    Left, Right, Down, Rotate, HardDrop, Pause, Restart
+};
+
+constexpr int COMMAND_COUNT = 7;
+
+// One queued input. The timestamp is when the input happened, in SDL performance-counter
+// ticks, so latency can be measured through to the frame that shows it.
+struct CommandRecord {
+    uint64_t timestamp;
+    Command command;
+};
+
+// Text names used by scripts: LEFT, RIGHT, DOWN, ROTATE, SPACE, Pause, RESTART.
+bool parseCommand(const std::string& text, Command& command);
+const char* commandName(Command command);
+
+#endif
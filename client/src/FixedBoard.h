@@ -0,0 +1,115 @@
+#ifndef FIXED_BOARD_H
+#define FIXED_BOARD_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "Board.h"
+#include "Tetromino.h"
+
+// Board with its size fixed at compile time: one mask per row in the narrowest integer
+// that holds Cols bits, constant loop bounds, and no heap. Same interface as Board, so
+// code templated on the board type (see Bot) runs on either; Board stays the fallback
+// for sizes with no specialization.
+template <int Rows, int Cols>
+class FixedBoard {
+public:
+    static_assert(Rows >= 4 && Cols >= 4 && Cols <= Board::MAX_COLS, "unsupported board size");
+
+    using Mask = std::conditional_t<(Cols <= 16), uint16_t, std::conditional_t<(Cols <= 32), uint32_t, uint64_t>>;
+
+    static constexpr Mask FULL_ROW = static_cast<Mask>(Cols == 64 ? ~0ull : (1ull << Cols) - 1);
+
+    FixedBoard() { clear(); }
+
+    // `board` must be Rows x Cols; see fits().
+    explicit FixedBoard(const Board& board) {
+        clear();
+        for (int row = board.getStackTop(); row < Rows; ++row) {
+            rows[PADDING + row] = static_cast<Mask>(board.getRowMask(row));
+        }
+        stackTop = board.getStackTop();
+    }
+
+    static bool fits(const Board& board) { return board.getRows() == Rows && board.getCols() == Cols; }
+
+    static constexpr int getRows() { return Rows; }
+    static constexpr int getCols() { return Cols; }
+    static constexpr uint64_t getFullRow() { return FULL_ROW; }
+    int getStackTop() const { return stackTop; }
+
+    uint64_t getRowMask(int row) const { return rows[PADDING + row]; }
+    void setRowMask(int row, uint64_t mask) {
+        rows[PADDING + row] = static_cast<Mask>(mask & FULL_ROW);
+        if (rows[PADDING + row]) {
+            stackTop = std::min(stackTop, row);
+        }
+    }
+
+    // The padding rows are always empty, so all MAX_SHAPE_SIZE rows of the shape can be
+    // tested without looking at its height.
+    bool checkCollision(const Tetromino& tetromino, int offsetX, int offsetY) const {
+        const auto& pos = tetromino.getPosition();
+        const ShapeData& shape = tetromino.getShape();
+        int x = pos.x + offsetX;
+        int y = pos.y + offsetY;
+        if (x < 0 || x + shape.width > Cols || y + shape.height > Rows) {
+            return true;
+        }
+        if (y < -PADDING) {
+            // Wholly above the board, where nothing is ever placed.
+            return false;
+        }
+
+        const Mask* window = &rows[PADDING + y];
+        Mask hit = 0;
+        for (int row = 0; row < MAX_SHAPE_SIZE; ++row) {
+            hit |= window[row] & static_cast<Mask>(static_cast<Mask>(shape.rowMasks[row]) << x);
+        }
+        return hit != 0;
+    }
+
+    void mergeTetromino(const Tetromino& tetromino) {
+        const auto& pos = tetromino.getPosition();
+        const ShapeData& shape = tetromino.getShape();
+        for (int row = 0; row < shape.height; ++row) {
+            if (pos.y + row >= 0) {
+                rows[PADDING + pos.y + row] |= static_cast<Mask>(static_cast<Mask>(shape.rowMasks[row]) << pos.x);
+            }
+        }
+        stackTop = std::min(stackTop, std::max(pos.y, 0));
+    }
+
+    int clearLines() {
+        int count = 0;
+        for (int row = Rows - 1; row >= stackTop; --row) {
+            if (rows[PADDING + row] == FULL_ROW) {
+                std::memmove(&rows[PADDING + stackTop + 1], &rows[PADDING + stackTop],
+                             (row - stackTop) * sizeof(Mask));
+                rows[PADDING + stackTop] = 0;
+                stackTop++;
+                count++;
+                ++row;
+            }
+        }
+        return count;
+    }
+
+    void clear() {
+        rows.fill(0);
+        stackTop = Rows;
+    }
+
+private:
+    static constexpr int PADDING = MAX_SHAPE_SIZE;
+
+    // Rows [0, Rows) live at rows[PADDING + row]; the padding above and below stays empty.
+    std::array<Mask, Rows + 2 * PADDING> rows;
+    int stackTop;
+};
+
+using StandardBoard = FixedBoard<Board::DEFAULT_ROWS, Board::DEFAULT_COLS>;
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <cstdint>
+#include <SDL2/SDL.h>
+#include "LatencyHistogram.h"
+
+// Per-game timing, measured with SDL_GetPerformanceCounter.
+struct FrameStats {
+    LatencyHistogram simulation;   // one Game::update
+    LatencyHistogram render;       // building one frame
+    LatencyHistogram present;      // SDL_RenderPresent
+    LatencyHistogram inputLatency; // key event until the frame showing its effect is presented
+
+    void reset() {
+        simulation.reset();
+        render.reset();
+        present.reset();
+        inputLatency.reset();
+    }
+
+    static uint64_t now() {
+        return SDL_GetPerformanceCounter();
+    }
+
+    static uint64_t toMicros(uint64_t counterDelta) {
+        static const uint64_t frequency = SDL_GetPerformanceFrequency();
+        return counterDelta * 1000000 / frequency;
+    }
+
+    // SDL event timestamps are SDL_GetTicks() milliseconds; move one onto the
+    // performance counter so it can be compared with frame timings.
+    static uint64_t fromEventTimestamp(Uint32 timestamp) {
+        uint64_t counter = now();
+        Uint32 age = SDL_GetTicks() - timestamp;
+        uint64_t ageCounts = static_cast<uint64_t>(age) * SDL_GetPerformanceFrequency() / 1000;
+        return ageCounts < counter ? counter - ageCounts : counter;
+    }
+};
+
+#endif
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <cstring>
+#include "FrameWriter.h"
+
+namespace {
+
+const uint8_t PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+// Deflate length and distance codes (RFC 1951, 3.2.5).
+const int LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                             31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const int LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const int DISTANCE_BASE[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                               193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const int DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+const int MAX_MATCH = 258;
+const int MAX_DISTANCE = 32768;
+
+void putBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+uint32_t crc32(const uint8_t* data, std::size_t size) {
+    static const auto table = []() {
+        std::vector<uint32_t> entries(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[i] = c;
+        }
+        return entries;
+    }();
+    uint32_t crc = 0xffffffffu;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+}
+
+struct Adler32 {
+    uint32_t a = 1;
+    uint32_t b = 0;
+
+    void update(const uint8_t* data, std::size_t size) {
+        while (size > 0) {
+            // The most bytes that can be summed before b could overflow.
+            std::size_t chunk = std::min<std::size_t>(size, 5552);
+            size -= chunk;
+            for (std::size_t i = 0; i < chunk; ++i) {
+                a += data[i];
+                b += a;
+            }
+            data += chunk;
+            a %= 65521;
+            b %= 65521;
+        }
+    }
+};
+
+// Bits go out least significant first, Huffman codes most significant first.
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out(out), bits(0), count(0) {}
+
+    void put(uint32_t value, int length) {
+        bits |= static_cast<uint64_t>(value) << count;
+        count += length;
+        while (count >= 8) {
+            out.push_back(static_cast<uint8_t>(bits));
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    // Fixed Huffman code for a literal/length symbol, bit-reversed ready for put().
+    void putSymbol(int symbol) {
+        struct Code {
+            uint16_t bits;
+            uint8_t length;
+        };
+        static const auto codes = []() {
+            std::vector<Code> table(288);
+            for (int s = 0; s < 288; ++s) {
+                uint32_t code;
+                int length;
+                if (s < 144) {
+                    code = 0x30 + s;
+                    length = 8;
+                } else if (s < 256) {
+                    code = 0x190 + s - 144;
+                    length = 9;
+                } else if (s < 280) {
+                    code = s - 256;
+                    length = 7;
+                } else {
+                    code = 0xc0 + s - 280;
+                    length = 8;
+                }
+                table[s] = {static_cast<uint16_t>(reverse(code, length)), static_cast<uint8_t>(length)};
+            }
+            return table;
+        }();
+        put(codes[symbol].bits, codes[symbol].length);
+    }
+
+    // `length` bytes copied from `distance` bytes back; length is at least 3.
+    void putMatch(int length, int distance) {
+        while (length > 0) {
+            int part = std::min(length, MAX_MATCH);
+            if (length - part > 0 && length - part < 3) {
+                part = length - 3;
+            }
+            length -= part;
+
+            int code = 28;
+            while (LENGTH_BASE[code] > part) {
+                --code;
+            }
+            putSymbol(257 + code);
+            put(part - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+
+            code = 29;
+            while (DISTANCE_BASE[code] > distance) {
+                --code;
+            }
+            put(reverse(code, 5), 5);
+            put(distance - DISTANCE_BASE[code], DISTANCE_EXTRA[code]);
+        }
+    }
+
+    void flush() {
+        if (count > 0) {
+            out.push_back(static_cast<uint8_t>(bits));
+        }
+        bits = 0;
+        count = 0;
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint64_t bits;
+    int count;
+
+    static uint32_t reverse(uint32_t code, int length) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        return reversed;
+    }
+};
+
+// PNG scanlines use filter 0, so the filtered image is each row's bytes behind a zero.
+// A pixel equal to its left neighbour is a match 4 bytes back; one equal to the pixel
+// above is a match one scanline back.
+void deflateImage(const Framebuffer& frame, std::vector<uint8_t>& out) {
+    const int width = frame.getWidth();
+    const int scanline = 1 + 4 * width;
+    const bool matchAbove = scanline <= MAX_DISTANCE;
+    const uint8_t filter = 0;
+
+    // zlib header: deflate with a 32K window, no dictionary, fastest level.
+    out.push_back(0x78);
+    out.push_back(0x01);
+    BitWriter bits(out);
+    bits.put(1, 1);
+    bits.put(1, 2);
+
+    Adler32 adler;
+    for (int y = 0; y < frame.getHeight(); ++y) {
+        const uint32_t* row = frame.getRow(y);
+        const uint32_t* above = y > 0 && matchAbove ? frame.getRow(y - 1) : nullptr;
+        adler.update(&filter, 1);
+        adler.update(reinterpret_cast<const uint8_t*>(row), static_cast<std::size_t>(width) * 4);
+
+        bits.putSymbol(filter);
+        for (int x = 0; x < width;) {
+            int left = 0;
+            if (x > 0) {
+                while (x + left < width && row[x + left] == row[x + left - 1]) {
+                    ++left;
+                }
+            }
+            int up = 0;
+            if (above) {
+                while (x + up < width && row[x + up] == above[x + up]) {
+                    ++up;
+                }
+            }
+
+            if (left == 0 && up == 0) {
+                uint8_t bytes[4];
+                std::memcpy(bytes, &row[x], sizeof(bytes));
+                for (uint8_t byte : bytes) {
+                    bits.putSymbol(byte);
+                }
+                ++x;
+            } else if (up > left) {
+                bits.putMatch(up * 4, scanline);
+                x += up;
+            } else {
+                bits.putMatch(left * 4, 4);
+                x += left;
+            }
+        }
+    }
+    bits.putSymbol(256);
+    bits.flush();
+    putBigEndian(out, adler.b << 16 | adler.a);
+}
+
+// Appends a chunk whose data is produced by `fill`.
+template <typename Fill>
+void putChunk(std::vector<uint8_t>& out, const char* type, Fill&& fill) {
+    std::size_t start = out.size();
+    putBigEndian(out, 0);
+    out.insert(out.end(), type, type + 4);
+    fill();
+    uint32_t length = static_cast<uint32_t>(out.size() - start - 8);
+    for (int i = 0; i < 4; ++i) {
+        out[start + i] = static_cast<uint8_t>(length >> (24 - 8 * i));
+    }
+    putBigEndian(out, crc32(out.data() + start + 4, length + 4));
+}
+
+bool writeFile(const std::string& path, const std::vector<uint8_t>& data) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    return std::fclose(file) == 0 && written;
+}
+
+}
+
+FrameWriter::FrameWriter()
+    : format(FrameFormat::Raw),
+      opened(false),
+      raw(nullptr),
+      frameCount(0),
+      bytesWritten(0) {
+}
+
+FrameWriter::~FrameWriter() {
+    close();
+}
+
+bool FrameWriter::open(const std::string& path, FrameFormat frameFormat) {
+    close();
+    dir = path;
+    format = frameFormat;
+    frameCount = 0;
+    bytesWritten = 0;
+    if (format == FrameFormat::Raw) {
+        raw = std::fopen((dir + "/frames.rgba").c_str(), "wb");
+        if (!raw) {
+            return false;
+        }
+    }
+    opened = true;
+    return true;
+}
+
+bool FrameWriter::write(const Framebuffer& frame) {
+    if (!opened) {
+        return false;
+    }
+    if (format == FrameFormat::Raw) {
+        std::size_t pixelCount = static_cast<std::size_t>(frame.getWidth()) * frame.getHeight();
+        if (std::fwrite(frame.getPixels(), sizeof(uint32_t), pixelCount, raw) != pixelCount) {
+            return false;
+        }
+        bytesWritten += pixelCount * sizeof(uint32_t);
+    } else {
+        char name[32];
+        std::snprintf(name, sizeof(name), "/frame_%06d.png", frameCount);
+        encodePng(frame, encoded);
+        if (!writeFile(dir + name, encoded)) {
+            return false;
+        }
+        bytesWritten += encoded.size();
+    }
+    frameCount++;
+    return true;
+}
+
+void FrameWriter::close() {
+    if (raw) {
+        std::fclose(raw);
+        raw = nullptr;
+    }
+    opened = false;
+}
+
+bool FrameWriter::writePng(const std::string& path, const Framebuffer& frame) {
+    std::vector<uint8_t> data;
+    encodePng(frame, data);
+    return writeFile(path, data);
+}
+
+void FrameWriter::encodePng(const Framebuffer& frame, std::vector<uint8_t>& out) {
+    out.assign(PNG_SIGNATURE, PNG_SIGNATURE + sizeof(PNG_SIGNATURE));
+    putChunk(out, "IHDR", [&]() {
+        putBigEndian(out, static_cast<uint32_t>(frame.getWidth()));
+        putBigEndian(out, static_cast<uint32_t>(frame.getHeight()));
+        // 8 bits per channel, RGBA, deflate, adaptive filtering, not interlaced.
+        const uint8_t format[5] = {8, 6, 0, 0, 0};
+        out.insert(out.end(), format, format + 5);
+    });
+    putChunk(out, "IDAT", [&]() { deflateImage(frame, out); });
+    putChunk(out, "IEND", []() {});
+}
@@ -0,0 +1,51 @@
+#ifndef FRAME_WRITER_H
+#define FRAME_WRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Framebuffer.h"
+
+enum class FrameFormat {
+    // Every frame appended to DIR/frames.rgba: headerless RGBA rows, which ffmpeg reads as
+    // -f rawvideo -pix_fmt rgba -s WxH.
+    Raw,
+    // One DIR/frame_<n>.png per frame, numbered from 000000.
+    Png,
+};
+
+// Streams rendered frames to disk. PNGs are encoded here without zlib: one fixed-Huffman
+// deflate block whose only matches repeat the previous pixel or the pixel above. That is
+// a few passes over memory per frame, and the flat frames of a board still come out at a
+// few kilobytes.
+class FrameWriter {
+public:
+    FrameWriter();
+    ~FrameWriter();
+    FrameWriter(const FrameWriter&) = delete;
+    FrameWriter& operator=(const FrameWriter&) = delete;
+
+    // `dir` must exist.
+    bool open(const std::string& dir, FrameFormat format);
+    bool isOpen() const { return opened; }
+    bool write(const Framebuffer& frame);
+    void close();
+    int getFrameCount() const { return frameCount; }
+    uint64_t getBytesWritten() const { return bytesWritten; }
+
+    static bool writePng(const std::string& path, const Framebuffer& frame);
+    // Replaces the contents of `out` with a PNG file for `frame`.
+    static void encodePng(const Framebuffer& frame, std::vector<uint8_t>& out);
+
+private:
+    std::string dir;
+    FrameFormat format;
+    bool opened;
+    std::FILE* raw;
+    int frameCount;
+    uint64_t bytesWritten;
+    std::vector<uint8_t> encoded;
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cstring>
+#include "Framebuffer.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// One byte per glyph row, the leftmost pixel in bit 2.
+struct Glyph {
+    char c;
+    uint8_t rows[Framebuffer::GLYPH_HEIGHT];
+};
+
+const Glyph GLYPHS[] = {
+    {'0', {7, 5, 5, 5, 7}}, {'1', {2, 6, 2, 2, 7}}, {'2', {7, 1, 7, 4, 7}}, {'3', {7, 1, 7, 1, 7}},
+    {'4', {5, 5, 7, 1, 1}}, {'5', {7, 4, 7, 1, 7}}, {'6', {7, 4, 7, 5, 7}}, {'7', {7, 1, 1, 1, 1}},
+    {'8', {7, 5, 7, 5, 7}}, {'9', {7, 5, 7, 1, 7}}, {'A', {2, 5, 7, 5, 5}}, {'B', {6, 5, 6, 5, 6}},
+    {'C', {3, 4, 4, 4, 3}}, {'D', {6, 5, 5, 5, 6}}, {'E', {7, 4, 6, 4, 7}}, {'F', {7, 4, 6, 4, 4}},
+    {'G', {3, 4, 5, 5, 3}}, {'H', {5, 5, 7, 5, 5}}, {'I', {7, 2, 2, 2, 7}}, {'J', {1, 1, 1, 5, 2}},
+    {'K', {5, 5, 6, 5, 5}}, {'L', {4, 4, 4, 4, 7}}, {'M', {5, 7, 7, 5, 5}}, {'N', {6, 5, 5, 5, 5}},
+    {'O', {2, 5, 5, 5, 2}}, {'P', {6, 5, 6, 4, 4}}, {'Q', {2, 5, 5, 6, 3}}, {'R', {6, 5, 6, 5, 5}},
+    {'S', {3, 4, 2, 1, 6}}, {'T', {7, 2, 2, 2, 2}}, {'U', {5, 5, 5, 5, 7}}, {'V', {5, 5, 5, 5, 2}},
+    {'W', {5, 5, 7, 7, 5}}, {'X', {5, 5, 2, 5, 5}}, {'Y', {5, 5, 2, 2, 2}}, {'Z', {7, 1, 2, 4, 7}},
+    {':', {0, 2, 0, 2, 0}}, {'/', {1, 1, 2, 4, 4}}, {'-', {0, 0, 7, 0, 0}}, {'.', {0, 0, 0, 0, 2}},
+};
+
+const uint8_t* glyphRows(char c) {
+    if (c >= 'a' && c <= 'z') {
+        c = static_cast<char>(c - 'a' + 'A');
+    }
+    for (const Glyph& glyph : GLYPHS) {
+        if (glyph.c == c) {
+            return glyph.rows;
+        }
+    }
+    return nullptr;
+}
+
+void fillSpan(uint32_t* out, int count, uint32_t color) {
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i fill = _mm_set1_epi32(static_cast<int>(color));
+    for (; i + 16 <= count; i += 16) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), fill);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), fill);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), fill);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 12), fill);
+    }
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), fill);
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = color;
+    }
+}
+
+// out = (out * (255 - alpha) + source * alpha) / 255 per channel, rounded. `terms` holds
+// source * alpha + 128 for R, G, B and A; the source alpha counts as 255, so an opaque
+// image stays opaque.
+inline uint8_t blendChannel(uint8_t value, int inverse, int term) {
+    int t = value * inverse + term;
+    return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+void blendSpan(uint32_t* out, int count, int alpha, const int terms[4]) {
+    const int inverse = 255 - alpha;
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i scale = _mm_set1_epi16(static_cast<short>(inverse));
+    const __m128i add = _mm_setr_epi16(static_cast<short>(terms[0]), static_cast<short>(terms[1]),
+                                       static_cast<short>(terms[2]), static_cast<short>(terms[3]),
+                                       static_cast<short>(terms[0]), static_cast<short>(terms[1]),
+                                       static_cast<short>(terms[2]), static_cast<short>(terms[3]));
+    auto blendHalf = [&](__m128i channels) {
+        __m128i t = _mm_add_epi16(_mm_mullo_epi16(channels, scale), add);
+        return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    };
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i));
+        __m128i low = blendHalf(_mm_unpacklo_epi8(pixels, zero));
+        __m128i high = blendHalf(_mm_unpackhi_epi8(pixels, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(low, high));
+    }
+#endif
+    for (; i < count; ++i) {
+        uint8_t bytes[4];
+        std::memcpy(bytes, &out[i], sizeof(bytes));
+        for (int channel = 0; channel < 4; ++channel) {
+            bytes[channel] = blendChannel(bytes[channel], inverse, terms[channel]);
+        }
+        std::memcpy(&out[i], bytes, sizeof(bytes));
+    }
+}
+
+}
+
+Framebuffer::Framebuffer(int width, int height)
+    : width(0),
+      height(0) {
+    resize(width, height);
+}
+
+void Framebuffer::resize(int newWidth, int newHeight) {
+    width = std::max(0, newWidth);
+    height = std::max(0, newHeight);
+    pixels.assign(static_cast<size_t>(width) * height, pack(Rgba()));
+}
+
+uint32_t Framebuffer::pack(Rgba color) {
+    const uint8_t bytes[4] = {color.r, color.g, color.b, color.a};
+    uint32_t value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+bool Framebuffer::clip(int& x, int& y, int& w, int& h) const {
+    int right = std::min(x + w, width);
+    int bottom = std::min(y + h, height);
+    x = std::max(x, 0);
+    y = std::max(y, 0);
+    w = right - x;
+    h = bottom - y;
+    return w > 0 && h > 0;
+}
+
+void Framebuffer::clear(Rgba color) {
+    fillSpan(pixels.data(), static_cast<int>(pixels.size()), pack(color));
+}
+
+void Framebuffer::fillRect(int x, int y, int w, int h, Rgba color) {
+    if (!clip(x, y, w, h)) {
+        return;
+    }
+    const uint32_t value = pack(color);
+    for (int row = y; row < y + h; ++row) {
+        fillSpan(getRow(row) + x, w, value);
+    }
+}
+
+void Framebuffer::drawRect(int x, int y, int w, int h, Rgba color) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    fillRect(x, y, w, 1, color);
+    fillRect(x, y + h - 1, w, 1, color);
+    fillRect(x, y + 1, 1, h - 2, color);
+    fillRect(x + w - 1, y + 1, 1, h - 2, color);
+}
+
+void Framebuffer::blendRect(int x, int y, int w, int h, Rgba color) {
+    if (!clip(x, y, w, h)) {
+        return;
+    }
+    const int alpha = color.a;
+    const int terms[4] = {color.r * alpha + 128, color.g * alpha + 128, color.b * alpha + 128, 255 * alpha + 128};
+    for (int row = y; row < y + h; ++row) {
+        blendSpan(getRow(row) + x, w, alpha, terms);
+    }
+}
+
+void Framebuffer::copyFrom(const Framebuffer& other) {
+    if (other.width == width && other.height == height) {
+        std::memcpy(pixels.data(), other.pixels.data(), pixels.size() * sizeof(uint32_t));
+    }
+}
+
+void Framebuffer::drawText(const std::string& text, int x, int y, int scale, Rgba color) {
+    for (char c : text) {
+        if (const uint8_t* rows = glyphRows(c)) {
+            for (int row = 0; row < GLYPH_HEIGHT; ++row) {
+                for (int col = 0; col < GLYPH_WIDTH; ++col) {
+                    if (rows[row] & (4 >> col)) {
+                        fillRect(x + col * scale, y + row * scale, scale, scale, color);
+                    }
+                }
+            }
+        }
+        x += (GLYPH_WIDTH + 1) * scale;
+    }
+}
+
+int Framebuffer::measureText(const std::string& text, int scale) {
+    return text.empty() ? 0 : static_cast<int>(text.size()) * (GLYPH_WIDTH + 1) * scale - scale;
+}
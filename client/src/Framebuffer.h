@@ -0,0 +1,61 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct Rgba {
+    uint8_t r = 0;
+    uint8_t g = 0;
+    uint8_t b = 0;
+    uint8_t a = 255;
+};
+
+// An RGBA image in memory, 8 bits per channel with R first in memory, rows top to bottom
+// and no padding between them. Drawing is limited to what the software renderer needs:
+// solid and translucent rectangles, clipped to the image, and a 3x5 bitmap font. The row
+// loops use SSE2 when the compiler targets it and plain loops otherwise; both give the
+// same pixels.
+class Framebuffer {
+public:
+    static constexpr int GLYPH_WIDTH = 3;
+    static constexpr int GLYPH_HEIGHT = 5;
+
+    explicit Framebuffer(int width = 0, int height = 0);
+
+    void resize(int width, int height);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    const uint32_t* getPixels() const { return pixels.data(); }
+    uint32_t* getRow(int y) { return pixels.data() + static_cast<size_t>(y) * width; }
+    const uint32_t* getRow(int y) const { return pixels.data() + static_cast<size_t>(y) * width; }
+    uint32_t getPixel(int x, int y) const { return getRow(y)[x]; }
+
+    static uint32_t pack(Rgba color);
+
+    void clear(Rgba color);
+    void fillRect(int x, int y, int w, int h, Rgba color);
+    // One pixel wide, inside the rectangle like SDL_RenderDrawRect.
+    void drawRect(int x, int y, int w, int h, Rgba color);
+    // Mixes `color` over the pixels by its alpha.
+    void blendRect(int x, int y, int w, int h, Rgba color);
+    // Same size required; used to start every frame from a cached background.
+    void copyFrom(const Framebuffer& other);
+
+    // Letters, digits and ": / - ." are drawn; lower case is drawn as upper case and
+    // anything else as a space. Each font pixel becomes a scale x scale square.
+    void drawText(const std::string& text, int x, int y, int scale, Rgba color);
+    static int measureText(const std::string& text, int scale);
+
+private:
+    int width;
+    int height;
+    std::vector<uint32_t> pixels;
+
+    // Clips the rectangle to the image; false when nothing is left.
+    bool clip(int& x, int& y, int& w, int& h) const;
+};
+
+#endif
@@ -1,38 +1,45 @@
 #include <SDL2/SDL.h>
+#include <algorithm>
 #include <vector>
 #include <iostream>
 #include <cstdlib>
 #include <ctime>
 #include <sstream>
+#include <random>
+#include <cstdio>
 #include <SDL2/SDL_ttf.h>
 #include "Game.h"
 #include "Constants.h"
+#include "Profiler.h"
 
 Game::Game()
     : window(nullptr),
       renderer(nullptr),
-      currentTetromino(nullptr),
+      ownsRenderer(false),
+      ttfStarted(false),
+      simulation(SIMULATION_STEP_MS),
+      lastUpdate(Clock::now()),
+      accumulated(0),
+      version(1),
+      remote(nullptr),
+      remoteInputTime(0),
       quit(false),
-      gameOver(false),
-      score(0),
-      paused(false),
-      lastTick(0) {
+      drawCalls(0),
+      showStats(false),
+      pendingInputTime(0),
+      drawnInputTime(0) {
 }
 
 Game::~Game() {
-    delete currentTetromino;
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    SDL_Quit();
+    cleanup();
 }
 
 void Game::setGameOver(bool flag) {
-    gameOver = flag;
+    simulation.getState().setGameOver(flag);
+    requestRedraw();
 }
 
 bool Game::initialize() {
-    gameOver = false;
-    board.clear();
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         std::cerr << "SDL initialization failed: " << SDL_GetError() << std::endl;
         return false;
@@ -42,6 +49,7 @@ bool Game::initialize() {
         std::cerr << "SDL_ttf could not initialize! SDL_ttf Error: " << TTF_GetError() << std::endl;
         return false;
     }
+    ttfStarted = true;
 
     window = SDL_CreateWindow("Tetris", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT, 0);
     if (!window) {
@@ -49,72 +57,49 @@ bool Game::initialize() {
         return false;
     }
 
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
     if (!renderer) {
         std::cerr << "Renderer creation failed: " << SDL_GetError() << std::endl;
         return false;
     }
-    
-    spawnTetromino();
+    ownsRenderer = true;
+
+    startRendering();
     return true;
 }
 
-void Game::spawnTetromino() {
-    TetrominoType type = static_cast<TetrominoType>(rand() % 7);
+bool Game::initializeOffscreen(SDL_Renderer* target) {
+    if (TTF_Init() == -1) {
+        std::cerr << "SDL_ttf could not initialize! SDL_ttf Error: " << TTF_GetError() << std::endl;
+        return false;
+    }
+    ttfStarted = true;
 
-    const auto& shape = TETROMINOS[static_cast<int>(type)];
+    renderer = target;
+    ownsRenderer = false;
 
-    Position startPos(COLS / 2 - static_cast<int>(shape[0].size()) / 2, 0);
+    startRendering();
+    return true;
+}
 
-    currentTetromino = new Tetromino(type, shape, startPos);
+void Game::startRendering() {
+    text = std::make_unique<TextRenderer>(renderer);
+    boardRenderer = std::make_unique<BoardRenderer>(renderer, *text);
 
-    if (board.checkCollision(*currentTetromino, 0, 0)) {
-        gameOver = true;
-    }
+    std::random_device entropy;
+    simulation.reset((static_cast<uint64_t>(entropy()) << 32) | entropy());
+    lastUpdate = Clock::now();
+    accumulated = std::chrono::microseconds(0);
 }
 
-void Game::handleInput(const std::string& command) {
-    if (gameOver) {
-        if (command == "RESTART") {
-            restartGame();
-        }
-        return;
-    }
-
-    if (command == "LEFT") {
-        if (!board.checkCollision(*currentTetromino, -1, 0)) {
-            currentTetromino->move(-1, 0);
-        }
-    } else if (command == "RIGHT") {
-        if (!board.checkCollision(*currentTetromino, 1, 0)) {
-            currentTetromino->move(1, 0);
-        }
-    } else if (command == "DOWN") {
-        if (!board.checkCollision(*currentTetromino, 0, 1)) {
-            currentTetromino->move(0, 1);
-        }
-    } else if (command == "ROTATE") {
-        currentTetromino->rotate();
-        if (board.checkCollision(*currentTetromino, 0, 0)) {
-            currentTetromino->rotate();
-            currentTetromino->rotate();
-            currentTetromino->rotate();
-        }
-    } else if (command == "SPACE") {
-        while (!board.checkCollision(*currentTetromino, 0, 1)) {
-            currentTetromino->move(0, 1);
-        }
-        board.mergeTetromino(*currentTetromino);
-        int count = board.clearLines();
-        calculateScore(count);
-        spawnTetromino();
-    } else if (command == "Pause"){
-        togglePause();
-    }
+bool Game::pushInput(Command command, uint64_t eventTime) {
+    PROFILE_ZONE("Game::pushInput");
+    return inputQueue.push({eventTime != 0 ? eventTime : FrameStats::now(), command});
 }
 
-void Game::calculateScore(int count) {
-    score += count * 15;
+void Game::handleInput(Command command) {
+    simulation.apply(command);
+    requestRedraw();
 }
 
 SDL_Color Game::getTetrominoColor(TetrominoType type) {
@@ -133,135 +118,110 @@ SDL_Color Game::getTetrominoColor(TetrominoType type) {
 void Game::render() {
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
     SDL_RenderClear(renderer);
-    if (paused) {
-            renderPauseOverlay();
-            return;
-        }
-
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
+    draw(simulation.getState());
 
-    if (gameOver) {
-        renderGameOverScreen();
+    uint64_t presentStart = FrameStats::now();
+    {
+        PROFILE_ZONE("SDL_RenderPresent");
         SDL_RenderPresent(renderer);
-        return;
     }
+    notePresented(presentStart, FrameStats::now());
+}
 
-    TTF_Font* font = TTF_OpenFont("../assets/Roboto-Thin.ttf", 24);
-
-    const auto& grid = board.getGrid();
-    for (int row = 0; row < ROWS; ++row) {
-        for (int col = 0; col < COLS; ++col) {
-            SDL_Rect cell = {col * CELL_SIZE, row * CELL_SIZE, CELL_SIZE, CELL_SIZE};
-            if (grid[row][col] == 0) {
-                SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
-                SDL_RenderFillRect(renderer, &cell);
-                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-                SDL_RenderDrawRect(renderer, &cell);
-            } else {
-                SDL_SetRenderDrawColor(renderer, LOCKED_COLOR.r, LOCKED_COLOR.g, LOCKED_COLOR.b, 255);
-                SDL_RenderFillRect(renderer, &cell);
-
-                SDL_SetRenderDrawColor(renderer, 200, 200, 200, 255);
-                SDL_RenderDrawRect(renderer, &cell);
-            }
-        }
+int Game::draw(const GameState& state) {
+    PROFILE_ZONE("Game::draw");
+    uint64_t frameStart = FrameStats::now();
+    // Inputs applied before this point are visible in the frame about to be drawn.
+    uint64_t inputTime = pendingInputTime.exchange(0, std::memory_order_acquire);
+    if (inputTime != 0 && drawnInputTime == 0) {
+        drawnInputTime = inputTime;
     }
 
-    const auto& shape = currentTetromino->getShape();
-    const auto& pos = currentTetromino->getPosition();
-
-    for (size_t row = 0; row < shape.size(); ++row) {
-        for (size_t col = 0; col < shape[row].size(); ++col) {
-            if (shape[row][col]) {
-                SDL_Rect cell = {
-                    static_cast<int>((pos.x + col) * CELL_SIZE),
-                    static_cast<int>((pos.y + row) * CELL_SIZE),
-                    CELL_SIZE,
-                    CELL_SIZE
-                };
-
-                SDL_Color tetrominoColor = getTetrominoColor(currentTetromino->getType());
-                SDL_SetRenderDrawColor(renderer, tetrominoColor.r, tetrominoColor.g, tetrominoColor.b, 255);
-                SDL_RenderFillRect(renderer, &cell);
-
-                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-                SDL_RenderDrawRect(renderer, &cell);
-            }
-        }
+    // SDL_RenderClear would ignore the viewport and wipe the other boards.
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_Rect area = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+    SDL_RenderFillRect(renderer, &area);
+    drawCalls = 2;
+    if (state.isPaused()) {
+        renderPauseOverlay();
+    } else if (state.isGameOver()) {
+        renderGameOverScreen(state);
+    } else {
+        drawCalls += boardRenderer->draw(state, getTetrominoColor(state.getCurrentTetromino().getType()));
     }
 
-    int SCORE_AREA_WIDTH = 200;
-    int SCORE_AREA_X = WINDOW_WIDTH - SCORE_AREA_WIDTH;
-    int SCORE_Y = 50;
-
-    SDL_Rect scoreBackground = {SCORE_AREA_X, 0, SCORE_AREA_WIDTH, WINDOW_HEIGHT};
-    SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
-    SDL_RenderFillRect(renderer, &scoreBackground);
+    if (showStats) {
+        renderStatsOverlay();
+    }
 
-    renderText("Score: " + std::to_string(score), font, SCORE_AREA_X + (SCORE_AREA_WIDTH / 2) - 50, SCORE_Y);
+    stats.render.record(FrameStats::toMicros(FrameStats::now() - frameStart));
+    return drawCalls;
+}
 
-    SDL_Rect pauseButtonRect = {SCORE_AREA_X + (SCORE_AREA_WIDTH - 140) / 2, SCORE_Y + 100, 150, 50};
-    SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
-    SDL_RenderFillRect(renderer, &pauseButtonRect);
-    renderText("Pause: P/E", font, pauseButtonRect.x + 20, pauseButtonRect.y + 10);
+void Game::notePresented(uint64_t presentStart, uint64_t presentEnd) {
+    stats.present.record(FrameStats::toMicros(presentEnd - presentStart));
+    if (drawnInputTime != 0) {
+        stats.inputLatency.record(FrameStats::toMicros(presentEnd - drawnInputTime));
+        drawnInputTime = 0;
+    }
+}
 
-    TTF_CloseFont(font);
-    SDL_RenderPresent(renderer);
+void Game::toggleStatsOverlay() {
+    showStats = !showStats;
+    if (showStats) {
+        stats.reset();
+    }
 }
 
-void Game::renderGameOverScreen() {
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-    SDL_RenderClear(renderer);
+// Timings in microseconds, drawn with the glyph atlas so the numbers can change every
+// frame without rasterizing new textures.
+void Game::renderStatsOverlay() {
+    struct Row {
+        const char* label;
+        const LatencyHistogram& histogram;
+    };
+    const Row rows[] = {
+        {"sim", stats.simulation},
+        {"render", stats.render},
+        {"present", stats.present},
+        {"input", stats.inputLatency},
+    };
+
+    const SDL_Color color = {255, 255, 255, 255};
+    const int x = WINDOW_WIDTH - 190;
+    int y = 230;
+    text->drawText("us    p50  p99  max", 14, x, y, color);
+    for (const Row& row : rows) {
+        y += 18;
+        char line[64];
+        std::snprintf(line, sizeof(line), "%-7s %4llu %4llu %4llu", row.label,
+                      static_cast<unsigned long long>(row.histogram.getPercentile(50)),
+                      static_cast<unsigned long long>(row.histogram.getPercentile(99)),
+                      static_cast<unsigned long long>(row.histogram.getMax()));
+        text->drawText(line, 14, x, y, color);
+    }
+}
 
+void Game::renderGameOverScreen(const GameState& state) {
     // Create a semi-transparent overlay
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 150);
     SDL_Rect overlayRect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
     SDL_RenderFillRect(renderer, &overlayRect);
 
-    // Load the font
-    TTF_Font* font = TTF_OpenFont("../assets/Roboto-Thin.ttf", 48);
-    if (!font) {
-        std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
-        return;
-    }
-
     // Render "Game Over" text
     SDL_Color textColor = {255, 0, 0, 255};
-    SDL_Surface* textSurface = TTF_RenderText_Solid(font, "Game Over", textColor);
-    if (textSurface) {
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-        SDL_Rect textRect = {(WINDOW_WIDTH - textSurface->w) / 2, (WINDOW_HEIGHT - textSurface->h) / 3, textSurface->w, textSurface->h};
-        SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
-        SDL_FreeSurface(textSurface);
-        SDL_DestroyTexture(textTexture);
-    }
+    const TextTexture& gameOverText = text->getStatic("Game Over", 48, textColor);
+    text->draw(gameOverText, (WINDOW_WIDTH - gameOverText.w) / 2, (WINDOW_HEIGHT - gameOverText.h) / 3);
 
     // Render score text
     SDL_Color scoreTextColor = {60, 179, 113, 255};
-    std::string scoreText = "Your score is: " + std::to_string(score);
-    textSurface = TTF_RenderText_Solid(font, scoreText.c_str(), scoreTextColor);
-    if (textSurface) {
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-        SDL_Rect textRect = {(WINDOW_WIDTH - textSurface->w) / 2, (WINDOW_HEIGHT - textSurface->h) / 2, textSurface->w, textSurface->h};
-        SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
-        SDL_FreeSurface(textSurface);
-        SDL_DestroyTexture(textTexture);
-    }
-
-    // Clean up font
-    TTF_CloseFont(font);
+    const TextTexture& scoreText = text->getValue("Your score is: ", state.getScore(), 48, scoreTextColor);
+    text->draw(scoreText, (WINDOW_WIDTH - scoreText.w) / 2, (WINDOW_HEIGHT - scoreText.h) / 2);
 }
 
 void Game::restartGame() {
-    gameOver = false;
-    score = 0;
-
-    board.clear();
-
-    spawnTetromino();
-
-    gameLoop();
+    simulation.getState().reset();
+    requestRedraw();
 }
 
 void Game::renderPauseOverlay() {
@@ -271,13 +231,9 @@ void Game::renderPauseOverlay() {
     SDL_RenderFillRect(renderer, &overlayRect);
 
     // Render "Paused" text
-    TTF_Font* font = TTF_OpenFont("../assets/Roboto-Thin.ttf", 48);
     SDL_Color textColor = {255, 255, 255, 255};
-    SDL_Surface* textSurface = TTF_RenderText_Solid(font, "Game is paused", textColor);
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-
-    SDL_Rect textRect = {(WINDOW_WIDTH - textSurface->w) / 2, (WINDOW_HEIGHT - textSurface->h) / 3, textSurface->w, textSurface->h};
-    SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
+    const TextTexture& pausedText = text->getStatic("Game is paused", 48, textColor);
+    text->draw(pausedText, (WINDOW_WIDTH - pausedText.w) / 2, (WINDOW_HEIGHT - pausedText.h) / 3);
 
     // Render "Resume" button
     SDL_Color buttonColor = {100, 100, 255, 255};
@@ -286,153 +242,204 @@ void Game::renderPauseOverlay() {
     SDL_RenderFillRect(renderer, &resumeButtonRect);
 
     // Render "Resume" button text
-    SDL_Surface* buttonSurface = TTF_RenderText_Solid(font, "Resume", textColor);
-    SDL_Texture* buttonTexture = SDL_CreateTextureFromSurface(renderer, buttonSurface);
-
-    SDL_Rect buttonTextRect = {resumeButtonRect.x + (resumeButtonRect.w - buttonSurface->w) / 2, 
-                               resumeButtonRect.y + (resumeButtonRect.h - buttonSurface->h) / 2, 
-                               buttonSurface->w, buttonSurface->h};
-    SDL_RenderCopy(renderer, buttonTexture, nullptr, &buttonTextRect);
-
-    // Clean up
-    SDL_FreeSurface(textSurface);
-    SDL_DestroyTexture(textTexture);
-    SDL_FreeSurface(buttonSurface);
-    SDL_DestroyTexture(buttonTexture);
-    TTF_CloseFont(font);
-
-    SDL_RenderPresent(renderer);
+    const TextTexture& buttonText = text->getStatic("Resume", 48, textColor);
+    text->draw(buttonText, resumeButtonRect.x + (resumeButtonRect.w - buttonText.w) / 2,
+               resumeButtonRect.y + (resumeButtonRect.h - buttonText.h) / 2);
 }
 
+// Only flips the state; the next render() shows or hides the overlay. This runs on the
+// simulation thread, which must not touch the renderer.
 void Game::togglePause() {
-    paused = !paused;
-
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-    SDL_RenderClear(renderer);
-    if (paused) {
-        renderPauseOverlay();
-    } else {
-        render();
-    }
-
-    SDL_RenderPresent(renderer); 
+    simulation.getState().togglePause();
+    requestRedraw();
 }
 
-void Game::renderText(const std::string& text, TTF_Font* font, int x, int y) {
-    if (!font) {
-        std::cerr << "Failed to load font! SDL_ttf Error: " << TTF_GetError() << std::endl;
+void Game::update(){
+    PROFILE_ZONE("Game::update");
+    uint64_t start = FrameStats::now();
+
+    if (remote) {
+        updateRemote();
+        stats.simulation.record(FrameStats::toMicros(FrameStats::now() - start));
         return;
     }
 
-    SDL_Color white = {255, 255, 255};
-    SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), white);
-    if (!surface) {
-        std::cerr << "Failed to create text surface! SDL_ttf Error: " << TTF_GetError() << std::endl;
-        return;
+    {
+        PROFILE_ZONE("Game::drainInput");
+        CommandRecord record;
+        while (inputQueue.pop(record)) {
+            handleInput(record.command);
+            uint64_t expected = 0;
+            pendingInputTime.compare_exchange_strong(expected, record.timestamp, std::memory_order_release,
+                                                     std::memory_order_relaxed);
+        }
     }
 
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (!texture) {
-        std::cerr << "Failed to create text texture! SDL Error: " << SDL_GetError() << std::endl;
-        SDL_FreeSurface(surface);
-        return;
+    // Whole steps of elapsed real time are simulated; the remainder carries over.
+    Clock::time_point now = Clock::now();
+    accumulated += std::chrono::duration_cast<std::chrono::microseconds>(now - lastUpdate);
+    lastUpdate = now;
+    if (accumulated > MAX_CATCH_UP) {
+        accumulated = MAX_CATCH_UP;
     }
 
-    SDL_Rect dstRect = {x, y, surface->w, surface->h};
-    SDL_RenderCopy(renderer, texture, NULL, &dstRect);
+    const std::chrono::microseconds step = std::chrono::milliseconds(SIMULATION_STEP_MS);
+    int steps = static_cast<int>(accumulated / step);
+    accumulated -= steps * step;
+    if (simulation.tick(steps) > 0) {
+        requestRedraw();
+    }
 
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(texture);
+    stats.simulation.record(FrameStats::toMicros(FrameStats::now() - start));
 }
 
-void Game::update(){
-    if(gameOver || paused) return;
+void Game::run(const std::vector<std::string>& commands) {
+    for (const auto& line : commands) {
+        if (quit || simulation.getState().isGameOver()) {
+            break;
+        }
 
-    Uint32 currentTick = SDL_GetTicks();
-    
-    if (currentTick - lastTick >= tickInterval) {
-        if (!board.checkCollision(*currentTetromino, 0, 1)) {
-            currentTetromino->move(0, 1);
-        } else {
-            if (lockStartTime == 0) {
-                lockStartTime = currentTick;
-            }
+        Command command;
+        if (parseCommand(line, command)) {
+            pushInput(command);
+        }
+        update();
+        render();
 
-            if (currentTick - lockStartTime >= LOCK_DELAY) {
-                board.mergeTetromino(*currentTetromino);
-                int count = board.clearLines();
-                calculateScore(count);
-                spawnTetromino();
-                lockStartTime = 0;
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) {
+                quit = true;
             }
         }
-
-        lastTick = currentTick;
+        SDL_Delay(16);
     }
-
 }
 
 void Game::cleanup() {
-    if (renderer) {
+    boardRenderer.reset();
+    text.reset();
+
+    // SDL_ttf counts TTF_Init() calls. The fonts are shared by every game, so whichever
+    // game makes the last TTF_Quit() closes them first.
+    if (ttfStarted) {
+        if (TTF_WasInit() == 1) {
+            TextRenderer::closeFonts();
+        }
+        TTF_Quit();
+        ttfStarted = false;
+    }
+
+    // An offscreen game draws into someone else's renderer and must leave SDL running.
+    bool ownedWindow = ownsRenderer;
+    if (renderer && ownsRenderer) {
         SDL_DestroyRenderer(renderer);
-        renderer = nullptr;
     }
+    renderer = nullptr;
+    ownsRenderer = false;
 
     if (window) {
         SDL_DestroyWindow(window);
         window = nullptr;
     }
-    gameOver = false;
-    window = nullptr;
-    renderer = nullptr;
-    currentTetromino = nullptr;
     quit = false;
-    gameOver = false;
-    score = 0;
-    paused = false;
-    lastTick = 0;
 
-    SDL_Quit();
+    if (ownedWindow) {
+        SDL_Quit();
+    }
+}
+
+// Inputs are forwarded as they are; the simulation runs on the server. Input latency is
+// measured to the first server update received after the input was sent.
+void Game::updateRemote() {
+    CommandRecord record;
+    while (inputQueue.pop(record)) {
+        remote->send(record.command);
+        if (remoteInputTime == 0) {
+            remoteInputTime = record.timestamp;
+        }
+    }
+
+    if (remote->poll(simulation.getState())) {
+        requestRedraw();
+        if (remoteInputTime != 0) {
+            uint64_t expected = 0;
+            pendingInputTime.compare_exchange_strong(expected, remoteInputTime, std::memory_order_release,
+                                                     std::memory_order_relaxed);
+            remoteInputTime = 0;
+        }
+    }
+
+    if (!remote->isConnected()) {
+        quit = true;
+    }
 }
 
+Game::Clock::time_point Game::getNextDeadline() const {
+    // Server updates can arrive at any time, so a remote game checks once per frame.
+    if (remote) {
+        return Clock::now() + FRAME_PERIOD;
+    }
+    uint32_t deadline = simulation.getNextDeadline();
+    if (deadline == GameState::NO_DEADLINE) {
+        return Clock::time_point::max();
+    }
+    return lastUpdate + std::chrono::milliseconds(deadline - simulation.getTime()) - accumulated;
+}
+
+void Game::handleEvent(const SDL_Event& event) {
+    if (event.type == SDL_QUIT) {
+        quit = true;
+    } else if (event.type == SDL_WINDOWEVENT) {
+        requestRedraw();
+    } else if (event.type == SDL_KEYDOWN) {
+        uint64_t eventTime = FrameStats::fromEventTimestamp(event.key.timestamp);
+        if (event.key.keysym.sym == SDLK_LEFT) {
+            pushInput(Command::Left, eventTime);
+        } else if (event.key.keysym.sym == SDLK_RIGHT) {
+            pushInput(Command::Right, eventTime);
+        } else if (event.key.keysym.sym == SDLK_DOWN) {
+            pushInput(Command::Down, eventTime);
+        } else if (event.key.keysym.sym == SDLK_UP) {
+            pushInput(Command::Rotate, eventTime);
+        } else if (event.key.keysym.sym == SDLK_SPACE) {
+            pushInput(Command::HardDrop, eventTime);
+        } else if (event.key.keysym.sym == SDLK_r) {
+            pushInput(Command::Restart, eventTime);
+        } else if (event.key.keysym.sym == SDLK_F3) {
+            toggleStatsOverlay();
+        }
+    }
+}
+
+// Sleeps in SDL_WaitEventTimeout until either input arrives or the game is next due to
+// change, and only redraws when something did change.
 void Game::gameLoop() {
+    PROFILE_THREAD("main");
+    uint64_t renderedVersion = 0;
+
     while (!quit) {
-        Uint32 currentTick = SDL_GetTicks();
-
-        if (!paused && (currentTick - lastTick >= tickInterval)) {
-            if (!gameOver) {
-                currentTetromino->move(0, 1);
-                if (board.checkCollision(*currentTetromino, 0, 1)) {
-                    board.mergeTetromino(*currentTetromino);
-                    int count = board.clearLines();
-                    calculateScore(count);
-                    spawnTetromino();
-                }
-            }
+        update();
+
+        uint64_t currentVersion = getVersion();
+        if (currentVersion != renderedVersion || showStats) {
             render();
-            lastTick = currentTick;
+            renderedVersion = currentVersion;
         }
 
+        Clock::time_point wakeAt = getNextDeadline();
+        if (showStats) {
+            wakeAt = std::min(wakeAt, Clock::now() + FRAME_PERIOD);
+        }
+        auto wait = std::chrono::ceil<std::chrono::milliseconds>(wakeAt - Clock::now());
+        int timeout = static_cast<int>(std::clamp<long long>(wait.count(), 0, 1000));
+
         SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) {
-                quit = true;
-            }
-            else if (event.type == SDL_KEYDOWN) {
-                if (event.key.keysym.sym == SDLK_LEFT) {
-                    handleInput("LEFT");
-                } else if (event.key.keysym.sym == SDLK_RIGHT) {
-                    handleInput("RIGHT");
-                } else if (event.key.keysym.sym == SDLK_DOWN) {
-                    handleInput("DOWN");
-                } else if (event.key.keysym.sym == SDLK_UP) {
-                    handleInput("ROTATE");
-                } else if (event.key.keysym.sym == SDLK_SPACE) {
-                    handleInput("SPACE");
-                } else if(event.key.keysym.sym = SDLK_r) {
-                    handleInput("RESTART");
-                }
+        if (SDL_WaitEventTimeout(&event, timeout)) {
+            handleEvent(event);
+            while (SDL_PollEvent(&event)) {
+                handleEvent(event);
             }
         }
     }
-}
\ No newline at end of file
+}
@@ -1,47 +1,107 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <string>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
-#include "Board.h"
+#include "BoardRenderer.h"
+#include "Command.h"
+#include "FrameStats.h"
+#include "GameState.h"
+#include "NetClient.h"
+#include "Simulator.h"
+#include "TextRenderer.h"
 #include "Tetromino.h"
 #include "Position.h"
+#include "SpscQueue.h"
 
 class Game {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // The simulation runs on its own logical clock at this fixed step, independent of
+    // how often update() is called.
+    static constexpr uint32_t SIMULATION_STEP_MS = 1;
+    // Real time beyond this is dropped rather than simulated in one burst after a stall.
+    static constexpr std::chrono::milliseconds MAX_CATCH_UP{250};
+    static constexpr std::chrono::milliseconds FRAME_PERIOD{16};
+
 private:
     SDL_Window* window;
     SDL_Renderer* renderer;
-    Board board;
-    Tetromino* currentTetromino;
+    bool ownsRenderer;
+    bool ttfStarted;
+    std::unique_ptr<TextRenderer> text;
+    std::unique_ptr<BoardRenderer> boardRenderer;
+    Simulator simulation;
+    // Real time that has passed but not yet been simulated.
+    Clock::time_point lastUpdate;
+    std::chrono::microseconds accumulated;
+    // Bumped whenever the game changes, so unchanged frames need not be redrawn.
+    std::atomic<uint64_t> version;
+    // When set, inputs go to the server and the board shown is the server's.
+    NetClient* remote;
+    uint64_t remoteInputTime;
+    // Filled by the input thread, drained by whichever thread runs update().
+    SpscQueue<CommandRecord, 64> inputQueue;
     bool quit;
-    bool gameOver;
-    Uint32 lastTick;
-    const Uint32 tickInterval = 500;
-    const Uint32 LOCK_DELAY = 100;
-    int score;
-    bool paused;
-    Uint32 lockStartTime = 0;
+    int drawCalls;
+    FrameStats stats;
+    bool showStats;
+    // Timestamp of the oldest input applied since the last frame, 0 when none; set by
+    // update() and claimed by the next draw().
+    std::atomic<uint64_t> pendingInputTime;
+    // What the last draw() claimed, until the present that shows it.
+    uint64_t drawnInputTime;
+
+    void startRendering();
+    void renderStatsOverlay();
+    void handleEvent(const SDL_Event& event);
+    void updateRemote();
 
 public:
     Game();
     ~Game();
     SDL_Window* getWindow() { return window; }
-    bool getGameOver() { return gameOver; }
+    bool getGameOver() { return simulation.getState().isGameOver(); }
+    const GameState& getState() const { return simulation.getState(); }
+    uint64_t getVersion() const { return version.load(std::memory_order_acquire); }
+    void requestRedraw() { version.fetch_add(1, std::memory_order_release); }
+    // When update() next has work to do without new input; Clock::time_point::max()
+    // while paused or over.
+    Clock::time_point getNextDeadline() const;
+    // SDL draw calls issued by the last render() of the board.
+    int getDrawCalls() const { return drawCalls; }
+    const FrameStats& getStats() const { return stats; }
+    // Shows p50/p99/max of the frame timings in the score panel; resets them when turned on.
+    void toggleStatsOverlay();
 
     bool initialize();
-    void spawnTetromino();
-    void handleInput(const std::string& command);
+    // Draws into a renderer owned by the caller (e.g. a software renderer); no window is created.
+    bool initializeOffscreen(SDL_Renderer* target);
+    // `eventTime` is when the input happened (FrameStats::now() clock); defaults to now.
+    bool pushInput(Command command, uint64_t eventTime = 0);
+    // Plays on a tetris_server instead of simulating locally. The client must outlive the game.
+    void setRemote(NetClient* client) { remote = client; }
+    void handleInput(Command command);
     SDL_Color getTetrominoColor(TetrominoType type);
-    void calculateScore(int count);
+    // Clears, draws and presents this game's own window.
     void render();
+    // Draws `state` into the renderer's current viewport without clearing or presenting,
+    // so several games can share one frame. Callers on another thread than update() pass
+    // a copy of getState() taken between ticks. Returns the SDL draw calls issued.
+    int draw(const GameState& state);
+    // Called after the present that showed the last draw(), with FrameStats::now() times.
+    void notePresented(uint64_t presentStart, uint64_t presentEnd);
     void renderPauseOverlay();
-    void renderGameOverScreen();
+    void renderGameOverScreen(const GameState& state);
     void restartGame();
     void togglePause();
-    void renderText(const std::string& text, TTF_Font* font, int x, int y);
     void update();
     void run(const std::vector<std::string>& commands);
     void cleanup();
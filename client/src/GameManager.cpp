@@ -0,0 +1,377 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include "Constants.h"
+#include "GameManager.h"
+#include "Profiler.h"
+
+namespace {
+
+struct KeyBinding {
+    SDL_Keycode key;
+    int player;
+    Command command;
+};
+
+const KeyBinding KEY_BINDINGS[] = {
+    {SDLK_w, 0, Command::Rotate},
+    {SDLK_a, 0, Command::Left},
+    {SDLK_s, 0, Command::Down},
+    {SDLK_d, 0, Command::Right},
+    {SDLK_SPACE, 0, Command::HardDrop},
+    {SDLK_e, 0, Command::Pause},
+
+    {SDLK_UP, 1, Command::Rotate},
+    {SDLK_LEFT, 1, Command::Left},
+    {SDLK_DOWN, 1, Command::Down},
+    {SDLK_RIGHT, 1, Command::Right},
+    {SDLK_RETURN, 1, Command::HardDrop},
+    {SDLK_p, 1, Command::Pause},
+};
+
+// Logical pixels between neighbouring boards and around the edge.
+const int BOARD_GAP = 10;
+// The window never starts larger than this share of the screen.
+const float MAX_SCREEN_SHARE = 0.9f;
+
+}
+
+GameManager::GameManager(int playerCount, int humanCount)
+    : mainWindow(nullptr),
+      mainRenderer(nullptr),
+      layoutWidth(0),
+      layoutHeight(0),
+      running(true),
+      showStats(false),
+      redrawEvent(0),
+      redrawPending(true),
+      lastFrame(std::chrono::steady_clock::now()),
+      reportedDrawCalls(0),
+      reportedFrames(0),
+      lastDrawCallReport(std::chrono::steady_clock::now()) {
+    for (int i = 0; i < playerCount; ++i) {
+        players.push_back(std::make_unique<Player>());
+        players.back()->bot = i >= humanCount;
+    }
+}
+
+GameManager::~GameManager() {
+    stopGames();
+    if (pool) {
+        pool->stop();
+    }
+
+    for (auto& player : players) {
+        player->game.cleanup();
+    }
+
+    SDL_DestroyRenderer(mainRenderer);
+    SDL_DestroyWindow(mainWindow);
+    SDL_Quit();
+}
+
+void GameManager::scheduleTick(int index, WorkerPool::Clock::time_point deadline, uint64_t generation) {
+    pool->schedule([this, index, generation]() { runGameLogic(index, generation); }, deadline);
+}
+
+// Runs a game's tick now. Any tick already queued for it becomes stale and is dropped
+// when it comes due.
+void GameManager::wakeGame(int index) {
+    Player& player = *players[index];
+    scheduleTick(index, WorkerPool::Clock::now(), ++player.generation);
+}
+
+// One tick of one game. The tick then schedules its successor for the game's next
+// deadline; a game that is paused or over sleeps until input wakes it.
+void GameManager::runGameLogic(int index, uint64_t generation) {
+    PROFILE_ZONE("GameManager::runGameLogic");
+    Player& player = *players[index];
+    std::lock_guard<std::mutex> lock(player.logicMutex);
+    if (!player.running || generation != player.generation) {
+        return;
+    }
+
+    Game& game = player.game;
+    uint64_t versionBefore = game.getVersion();
+
+    // A bot places one whole piece per tick, feeding its plan straight into the game on
+    // the worker that owns it.
+    bool botActive = player.bot && !game.getState().isPaused() && !game.getGameOver();
+    if (botActive) {
+        PROFILE_ZONE("Bot::plan");
+        BotMove move = bot->plan(game.getState());
+        for (int i = 0; i < move.commandCount; ++i) {
+            game.handleInput(move.commands[i]);
+        }
+    }
+
+    game.update();
+    player.over = game.getGameOver();
+    {
+        std::lock_guard<std::mutex> snapshotLock(player.snapshotMutex);
+        player.snapshot = game.getState();
+    }
+
+    if (game.getVersion() != versionBefore) {
+        requestRedraw();
+    }
+
+    WorkerPool::Clock::time_point next = game.getNextDeadline();
+    if (botActive && !player.over) {
+        next = std::min(next, WorkerPool::Clock::now() + BOT_PERIOD);
+    }
+    if (next != WorkerPool::Clock::time_point::max()) {
+        scheduleTick(index, next, generation);
+    }
+}
+
+// Called from workers. Only the first request after a frame posts an event.
+void GameManager::requestRedraw() {
+    if (!redrawPending.exchange(true) && redrawEvent != static_cast<Uint32>(-1)) {
+        SDL_Event event;
+        SDL_zero(event);
+        event.type = redrawEvent;
+        SDL_PushEvent(&event);
+    }
+}
+
+// Runs on the event thread; the game's worker applies the command right away.
+void GameManager::handleGameInput(int index, Command command, uint64_t eventTime) {
+    if (index >= static_cast<int>(players.size())) {
+        return;
+    }
+    players[index]->game.pushInput(command, eventTime);
+    wakeGame(index);
+}
+
+void GameManager::processEvent(const SDL_Event& event) {
+    PROFILE_ZONE("GameManager::processEvent");
+    if (event.type == SDL_QUIT) {
+        stopGames();
+    } else if (event.type == SDL_WINDOWEVENT) {
+        handleWindowEvent(event);
+        redrawPending = true;
+    } else if (event.type == SDL_KEYDOWN && event.key.repeat == 0) {
+        handleKeyDown(event.key.keysym.sym, FrameStats::fromEventTimestamp(event.key.timestamp));
+    }
+}
+
+void GameManager::handleWindowEvent(const SDL_Event& event) {
+    if (event.window.event == SDL_WINDOWEVENT_CLOSE && event.window.windowID == SDL_GetWindowID(mainWindow)) {
+        stopGames();
+    }
+}
+
+void GameManager::handleKeyDown(SDL_Keycode key, uint64_t eventTime) {
+    switch (key) {
+        case SDLK_F3:
+            // Rendering happens on this thread, so the overlay flag needs no locking.
+            showStats = !showStats;
+            for (auto& player : players) {
+                player->game.toggleStatsOverlay();
+            }
+            redrawPending = true;
+            return;
+
+        case SDLK_r:
+            restartGames();
+            return;
+
+        case SDLK_q:
+            stopGames();
+            return;
+    }
+
+    for (const auto& binding : KEY_BINDINGS) {
+        if (binding.key == key) {
+            handleGameInput(binding.player, binding.command, eventTime);
+        }
+    }
+}
+
+// Boards go into the squarest grid that holds them all, row by row.
+void GameManager::layoutBoards() {
+    int count = static_cast<int>(players.size());
+    int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    int rows = (count + columns - 1) / columns;
+
+    viewports.clear();
+    for (int i = 0; i < count; ++i) {
+        int column = i % columns;
+        int row = i / columns;
+        viewports.push_back({BOARD_GAP + column * (WINDOW_WIDTH + BOARD_GAP),
+                             BOARD_GAP + row * (WINDOW_HEIGHT + BOARD_GAP), WINDOW_WIDTH, WINDOW_HEIGHT});
+    }
+    layoutWidth = BOARD_GAP + columns * (WINDOW_WIDTH + BOARD_GAP);
+    layoutHeight = BOARD_GAP + rows * (WINDOW_HEIGHT + BOARD_GAP);
+}
+
+// One clear, every board into its own viewport, one present.
+void GameManager::renderGames() {
+    PROFILE_ZONE("GameManager::renderGames");
+    SDL_RenderSetViewport(mainRenderer, nullptr);
+    SDL_SetRenderDrawColor(mainRenderer, 0, 0, 0, 255);
+    SDL_RenderClear(mainRenderer);
+
+    int drawCalls = 0;
+    for (int i = 0; i < static_cast<int>(players.size()); ++i) {
+        Player& player = *players[i];
+        if (player.running) {
+            {
+                std::lock_guard<std::mutex> snapshotLock(player.snapshotMutex);
+                player.drawn = player.snapshot;
+            }
+            SDL_RenderSetViewport(mainRenderer, &viewports[i]);
+            drawCalls += player.game.draw(player.drawn);
+        }
+    }
+    SDL_RenderSetViewport(mainRenderer, nullptr);
+
+    uint64_t presentStart = FrameStats::now();
+    {
+        PROFILE_ZONE("SDL_RenderPresent");
+        SDL_RenderPresent(mainRenderer);
+    }
+    uint64_t presentEnd = FrameStats::now();
+    for (auto& player : players) {
+        if (player->running) {
+            player->game.notePresented(presentStart, presentEnd);
+        }
+    }
+
+    reportedDrawCalls += drawCalls;
+    reportedFrames++;
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastDrawCallReport >= DRAW_CALL_REPORT_PERIOD) {
+        std::cout << "Draw calls per frame: " << reportedDrawCalls / reportedFrames
+                  << " across " << players.size() << " boards" << std::endl;
+        reportedDrawCalls = 0;
+        reportedFrames = 0;
+        lastDrawCallReport = now;
+    }
+}
+
+void GameManager::stopGames() {
+    running = false;
+    for (auto& player : players) {
+        player->running = false;
+    }
+}
+
+void GameManager::restartGames() {
+    for (const auto& player : players) {
+        if (player->running && !player->over) {
+            return;
+        }
+    }
+
+    for (int i = 0; i < static_cast<int>(players.size()); ++i) {
+        if (players[i]->running) {
+            handleGameInput(i, Command::Restart, 0);
+        }
+    }
+}
+
+bool GameManager::needsRedraw() {
+    return redrawPending.load() || showStats;
+}
+
+bool GameManager::anyGameRunning() const {
+    for (const auto& player : players) {
+        if (player->running) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GameManager::initialize() {
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL_Init failed: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    layoutBoards();
+    int windowWidth = layoutWidth;
+    int windowHeight = layoutHeight;
+    SDL_Rect screen;
+    if (SDL_GetDisplayUsableBounds(0, &screen) == 0) {
+        float scale = std::min({1.0f, MAX_SCREEN_SHARE * screen.w / layoutWidth, MAX_SCREEN_SHARE * screen.h / layoutHeight});
+        windowWidth = static_cast<int>(layoutWidth * scale);
+        windowHeight = static_cast<int>(layoutHeight * scale);
+    }
+
+    mainWindow = SDL_CreateWindow("Multiplayer Tetris", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowWidth,
+                                  windowHeight, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
+    if (!mainWindow) {
+        std::cerr << "Failed to create SDL main window: " << SDL_GetError() << std::endl;
+        SDL_Quit();
+        return false;
+    }
+
+    mainRenderer = SDL_CreateRenderer(mainWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
+    if (!mainRenderer) {
+        std::cerr << "Failed to create SDL renderer: " << SDL_GetError() << std::endl;
+        SDL_DestroyWindow(mainWindow);
+        SDL_Quit();
+        return false;
+    }
+    SDL_RenderSetLogicalSize(mainRenderer, layoutWidth, layoutHeight);
+
+    for (auto& player : players) {
+        if (!player->game.initializeOffscreen(mainRenderer)) {
+            std::cerr << "Failed to initialize one of the game instances." << std::endl;
+            SDL_DestroyRenderer(mainRenderer);
+            SDL_DestroyWindow(mainWindow);
+            SDL_Quit();
+            return false;
+        }
+    }
+
+    int threadCount = std::min(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())),
+                               static_cast<int>(players.size()));
+    pool = std::make_unique<WorkerPool>(threadCount);
+    bot = std::make_unique<Bot>(BotWeights(), pool.get());
+
+    redrawEvent = SDL_RegisterEvents(1);
+
+    for (int i = 0; i < static_cast<int>(players.size()); ++i) {
+        wakeGame(i);
+    }
+
+    return true;
+}
+
+void GameManager::run() {
+    PROFILE_THREAD("main");
+    SDL_Event event;
+
+    while (running) {
+        // Block until an event arrives: input, a window event, or a worker's redraw
+        // request. With a redraw pending, wait no longer than the frame period allows.
+        int timeout = IDLE_WAIT_MS;
+        if (needsRedraw()) {
+            auto wait = std::chrono::ceil<std::chrono::milliseconds>(lastFrame + FRAME_PERIOD - std::chrono::steady_clock::now());
+            timeout = static_cast<int>(std::max<long long>(0, wait.count()));
+        }
+
+        if (SDL_WaitEventTimeout(&event, timeout)) {
+            processEvent(event);
+            while (SDL_PollEvent(&event)) {
+                processEvent(event);
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (needsRedraw() && now >= lastFrame + FRAME_PERIOD) {
+            redrawPending = false;
+            lastFrame = now;
+            renderGames();
+        }
+
+        if (!anyGameRunning()) {
+            running = false;
+        }
+    }
+}
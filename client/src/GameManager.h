@@ -0,0 +1,96 @@
+#ifndef GAME_MANAGER_H
+#define GAME_MANAGER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+#include "Bot.h"
+#include "Game.h"
+#include "GameState.h"
+#include "WorkerPool.h"
+
+// Hosts any number of local games. Game ticks run on a fixed-size WorkerPool, so the
+// number of threads is bounded by the core count rather than by the number of players.
+// A game's tick is scheduled for its next deadline or brought forward by input, and the
+// main thread sleeps until a worker reports a changed board, so idle games cost nothing.
+// All boards share one window and renderer: each is drawn into its own viewport and the
+// frame is presented once.
+class GameManager {
+private:
+    struct Player {
+        Game game;
+        std::atomic<bool> running{true};
+        std::atomic<bool> over{false};
+        bool bot = false;
+        // Serializes ticks; a tick whose generation is stale was superseded by a wake-up.
+        std::mutex logicMutex;
+        std::atomic<uint64_t> generation{0};
+        // The game as of the end of its last tick, for the main thread to draw. Workers
+        // replace it under snapshotMutex and renderGames() copies it out the same way;
+        // a GameState copy never allocates, so neither side holds the lock for long.
+        std::mutex snapshotMutex;
+        GameState snapshot;
+        // The main thread's copy of snapshot, drawn without holding any lock.
+        GameState drawn;
+    };
+
+    // How often a bot gets to place a piece.
+    static constexpr std::chrono::milliseconds BOT_PERIOD{16};
+    static constexpr std::chrono::milliseconds FRAME_PERIOD{16};
+    static constexpr int IDLE_WAIT_MS = 500;
+
+    std::vector<std::unique_ptr<Player>> players;
+    std::unique_ptr<WorkerPool> pool;
+    std::unique_ptr<Bot> bot;
+
+    SDL_Window* mainWindow;
+    SDL_Renderer* mainRenderer;
+    // One viewport per player, in logical coordinates; SDL scales the whole layout to
+    // whatever size the window has.
+    std::vector<SDL_Rect> viewports;
+    int layoutWidth;
+    int layoutHeight;
+
+    bool running;
+    bool showStats;
+
+    // Posted by workers to wake the main thread; redrawPending coalesces them.
+    Uint32 redrawEvent;
+    std::atomic<bool> redrawPending;
+    std::chrono::steady_clock::time_point lastFrame;
+
+    // Draw-call totals, logged every DRAW_CALL_REPORT_PERIOD.
+    static constexpr std::chrono::seconds DRAW_CALL_REPORT_PERIOD{5};
+    long long reportedDrawCalls;
+    int reportedFrames;
+    std::chrono::steady_clock::time_point lastDrawCallReport;
+
+    void scheduleTick(int index, WorkerPool::Clock::time_point deadline, uint64_t generation);
+    void runGameLogic(int index, uint64_t generation);
+    void wakeGame(int index);
+    void requestRedraw();
+    bool needsRedraw();
+    void handleGameInput(int index, Command command, uint64_t eventTime);
+    void processEvent(const SDL_Event& event);
+    void handleWindowEvent(const SDL_Event& event);
+    void handleKeyDown(SDL_Keycode key, uint64_t eventTime);
+    void layoutBoards();
+    void renderGames();
+    void stopGames();
+    void restartGames();
+    bool anyGameRunning() const;
+
+public:
+    // Players beyond the first `humanCount` are driven by the placement bot.
+    explicit GameManager(int playerCount = 2, int humanCount = 2);
+    ~GameManager();
+
+    bool initialize();
+    void run();
+};
+
+#endif
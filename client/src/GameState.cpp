@@ -0,0 +1,185 @@
+#include "GameState.h"
+
+GameState::GameState()
+    : currentTetromino(TetrominoType::I, Position()),
+      gameOver(false),
+      paused(false),
+      score(0),
+      lastTick(0),
+      lockStartTime(0),
+      locking(false),
+      piecesPlaced(0),
+      linesCleared(0),
+      seed(0),
+      randomizer(Randomizer::Uniform),
+      boardSize(Board::DEFAULT_SIZE) {
+}
+
+void GameState::setGameOver(bool flag) {
+    gameOver = flag;
+}
+
+void GameState::restore(const Board& newBoard, const Tetromino& piece, int newScore, int pieces, int lines,
+                        bool over, bool isPaused) {
+    board = newBoard;
+    currentTetromino = piece;
+    score = newScore;
+    piecesPlaced = pieces;
+    linesCleared = lines;
+    gameOver = over;
+    paused = isPaused;
+}
+
+void GameState::reset() {
+    gameOver = false;
+    paused = false;
+    score = 0;
+    lastTick = 0;
+    lockStartTime = 0;
+    locking = false;
+    piecesPlaced = 0;
+    linesCleared = 0;
+
+    board.clear();
+
+    spawnTetromino();
+}
+
+// Starts over with a freshly seeded piece sequence. reset() alone keeps drawing from the
+// current sequence, so a restarted game gets new pieces.
+void GameState::reset(uint64_t newSeed) {
+    seed = newSeed;
+    pieces.reset(seed, randomizer);
+    if (board.getRows() != boardSize.rows || board.getCols() != boardSize.cols) {
+        board = Board(boardSize);
+    }
+    reset();
+}
+
+Tetromino GameState::makeSpawnTetromino(TetrominoType type, int cols) {
+    const auto& shape = SHAPE_TABLE.shapes[static_cast<int>(type)][0];
+
+    Position startPos(cols / 2 - shape.width / 2, 0);
+
+    return Tetromino(type, startPos);
+}
+
+Tetromino GameState::makeSpawnTetromino(TetrominoType type) const {
+    return makeSpawnTetromino(type, board.getCols());
+}
+
+void GameState::spawnTetromino() {
+    TetrominoType type = pieces.next();
+
+    currentTetromino = makeSpawnTetromino(type);
+
+    if (board.checkCollision(currentTetromino, 0, 0)) {
+        gameOver = true;
+    }
+}
+
+void GameState::lockTetromino() {
+    board.mergeTetromino(currentTetromino);
+    int count = board.clearLines();
+    calculateScore(count);
+    piecesPlaced++;
+    linesCleared += count;
+    locking = false;
+    spawnTetromino();
+}
+
+void GameState::handleInput(Command command) {
+    if (gameOver) {
+        if (command == Command::Restart) {
+            reset();
+        }
+        return;
+    }
+
+    if (command == Command::Pause) {
+        togglePause();
+        return;
+    }
+
+    if (paused) {
+        return;
+    }
+
+    switch (command) {
+        case Command::Left:
+            if (!board.checkCollision(currentTetromino, -1, 0)) {
+                currentTetromino.move(-1, 0);
+            }
+            break;
+        case Command::Right:
+            if (!board.checkCollision(currentTetromino, 1, 0)) {
+                currentTetromino.move(1, 0);
+            }
+            break;
+        case Command::Down:
+            if (!board.checkCollision(currentTetromino, 0, 1)) {
+                currentTetromino.move(0, 1);
+            }
+            break;
+        case Command::Rotate:
+            currentTetromino.rotate();
+            if (board.checkCollision(currentTetromino, 0, 0)) {
+                currentTetromino.rotateBack();
+            }
+            break;
+        case Command::HardDrop:
+            while (!board.checkCollision(currentTetromino, 0, 1)) {
+                currentTetromino.move(0, 1);
+            }
+            lockTetromino();
+            break;
+        default:
+            break;
+    }
+}
+
+void GameState::calculateScore(int count) {
+    score += count * POINTS_PER_LINE;
+}
+
+void GameState::togglePause() {
+    paused = !paused;
+}
+
+// Gravity moves the piece every TICK_INTERVAL. Once gravity finds it resting, the piece
+// locks LOCK_DELAY later unless it has been moved somewhere it can fall again.
+void GameState::update(uint32_t currentTick) {
+    if (gameOver || paused) return;
+
+    if (currentTick - lastTick >= TICK_INTERVAL) {
+        if (!board.checkCollision(currentTetromino, 0, 1)) {
+            currentTetromino.move(0, 1);
+            locking = false;
+        } else if (!locking) {
+            locking = true;
+            lockStartTime = currentTick;
+        }
+
+        lastTick = currentTick;
+    }
+
+    if (locking && currentTick - lockStartTime >= LOCK_DELAY) {
+        if (board.checkCollision(currentTetromino, 0, 1)) {
+            lockTetromino();
+        } else {
+            locking = false;
+        }
+    }
+}
+
+uint32_t GameState::getNextDeadline() const {
+    if (gameOver || paused) {
+        return NO_DEADLINE;
+    }
+
+    uint32_t deadline = lastTick + TICK_INTERVAL;
+    if (locking && lockStartTime + LOCK_DELAY < deadline) {
+        deadline = lockStartTime + LOCK_DELAY;
+    }
+    return deadline;
+}
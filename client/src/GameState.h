@@ -0,0 +1,78 @@
+#ifndef GAME_STATE_H
+#define GAME_STATE_H
+
+#include <cstdint>
+#include "Board.h"
+#include "Command.h"
+#include "PieceGenerator.h"
+#include "Tetromino.h"
+
+// Pure game logic with no SDL dependency. Time is passed in explicitly so the same
+// rules can run against SDL_GetTicks() in the client or a logical clock when headless.
+// Copying a GameState never allocates (standard boards hold their rows inline, tall ones
+// share them copy-on-write, everything else is plain data), so games can be saved, forked
+// and rolled back by value.
+class GameState {
+private:
+    Board board;
+    // Held by value: spawning a piece only overwrites it.
+    Tetromino currentTetromino;
+    bool gameOver;
+    bool paused;
+    int score;
+    uint32_t lastTick;
+    uint32_t lockStartTime;
+    bool locking;
+    int piecesPlaced;
+    int linesCleared;
+    uint64_t seed;
+    Randomizer randomizer;
+    BoardSize boardSize;
+    PieceGenerator pieces;
+
+    void lockTetromino();
+
+public:
+    static constexpr uint32_t TICK_INTERVAL = 500;
+    static constexpr uint32_t LOCK_DELAY = 100;
+    static constexpr uint32_t NO_DEADLINE = UINT32_MAX;
+    static constexpr int POINTS_PER_LINE = 15;
+
+    // A new piece of `type` where it enters a board `cols` wide.
+    static Tetromino makeSpawnTetromino(TetrominoType type, int cols);
+
+    GameState();
+
+    const Board& getBoard() const { return board; }
+    const Tetromino& getCurrentTetromino() const { return currentTetromino; }
+    bool isGameOver() const { return gameOver; }
+    bool isPaused() const { return paused; }
+    int getScore() const { return score; }
+    int getPiecesPlaced() const { return piecesPlaced; }
+    int getLinesCleared() const { return linesCleared; }
+    uint64_t getSeed() const { return seed; }
+    Randomizer getRandomizer() const { return randomizer; }
+    const PieceGenerator& getPieceGenerator() const { return pieces; }
+
+    // Both take effect on the next reset(seed).
+    void setRandomizer(Randomizer newRandomizer) { randomizer = newRandomizer; }
+    void setBoardSize(BoardSize size) { boardSize = size; }
+
+    void setGameOver(bool flag);
+    // Overwrites what is visible with a state received from an authoritative server.
+    void restore(const Board& newBoard, const Tetromino& piece, int newScore, int pieces, int lines,
+                 bool over, bool isPaused);
+    void reset();
+    void reset(uint64_t newSeed);
+    Tetromino makeSpawnTetromino(TetrominoType type) const;
+    void spawnTetromino();
+    void handleInput(Command command);
+    void calculateScore(int count);
+    void togglePause();
+    void update(uint32_t currentTick);
+    // Earliest time at which update() would change anything, or NO_DEADLINE while paused
+    // or over. Calling update() any earlier is a no-op, so callers can sleep until then.
+    uint32_t getNextDeadline() const;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "LatencyHistogram.h"
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+// Values below SUB_BUCKETS get one bucket each; above that, the top SUB_BUCKET_BITS + 1
+// significant bits pick the bucket within the value's power of two.
+int LatencyHistogram::bucketOf(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<int>(value);
+    }
+    int exponent = 63 - __builtin_clzll(value);
+    int shift = exponent - SUB_BUCKET_BITS;
+    int subBucket = static_cast<int>(value >> shift) - SUB_BUCKETS;
+    return SUB_BUCKETS + shift * SUB_BUCKETS + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < SUB_BUCKETS) {
+        return static_cast<uint64_t>(index);
+    }
+    int shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    uint64_t subBucket = static_cast<uint64_t>((index - SUB_BUCKETS) % SUB_BUCKETS);
+    return ((SUB_BUCKETS + subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t micros) {
+    buckets[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t previous = maximum.load(std::memory_order_relaxed);
+    while (micros > previous && !maximum.compare_exchange_weak(previous, micros, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::getPercentile(double percentile) const {
+    uint64_t count = getCount();
+    if (count == 0) {
+        return 0;
+    }
+
+    uint64_t target = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(count) + 0.5);
+    if (target == 0) {
+        target = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            uint64_t bound = bucketUpperBound(i);
+            uint64_t max = getMax();
+            return bound < max ? bound : max;
+        }
+    }
+    return getMax();
+}
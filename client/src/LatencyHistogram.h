@@ -0,0 +1,35 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+// HDR-style log-linear histogram of durations in microseconds. Each power of two is split
+// into 16 linear sub-buckets, so any recorded value is reported within about 6%.
+// record() is lock-free and may be called from any thread while another thread reads.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(uint64_t micros);
+    void reset();
+
+    uint64_t getCount() const { return total.load(std::memory_order_relaxed); }
+    uint64_t getMax() const { return maximum.load(std::memory_order_relaxed); }
+    // Smallest bucket bound that covers `percentile` (0-100) of the recorded values.
+    uint64_t getPercentile(double percentile) const;
+
+private:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int BUCKET_COUNT = SUB_BUCKETS + (64 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    std::atomic<uint64_t> buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> maximum;
+
+    static int bucketOf(uint64_t value);
+    static uint64_t bucketUpperBound(int index);
+};
+
+#endif
@@ -0,0 +1,172 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "NetClient.h"
+
+NetClient::NetClient()
+    : fd(-1),
+      slot(-1),
+      spectating(false),
+      watched(0) {
+}
+
+NetClient::~NetClient() {
+    close();
+}
+
+bool NetClient::connect(const std::string& host, uint16_t port, uint32_t room, bool spectate) {
+    close();
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    int error = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses);
+    if (error != 0) {
+        std::cerr << "Cannot resolve " << host << ": " << gai_strerror(error) << std::endl;
+        return false;
+    }
+
+    for (addrinfo* address = addresses; address && fd < 0; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd >= 0 && ::connect(fd, address->ai_addr, address->ai_addrlen) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+
+    if (fd < 0) {
+        std::cerr << "Cannot connect to " << host << ":" << port << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+    spectating = spectate;
+    if (spectate) {
+        encodeSpectate(output, room);
+    } else {
+        encodeJoin(output, room);
+    }
+    return flush();
+}
+
+void NetClient::close() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    fd = -1;
+    slot = -1;
+    input = FrameParser();
+    output.clear();
+    boards.clear();
+}
+
+bool NetClient::send(Command command) {
+    if (fd < 0) {
+        return false;
+    }
+    if (spectating) {
+        return true;
+    }
+    encodeInput(output, command);
+    return flush();
+}
+
+// Anything the socket does not take now stays queued for the next send() or poll().
+bool NetClient::flush() {
+    std::size_t written = 0;
+    while (written < output.size()) {
+        ssize_t sent = ::send(fd, output.data() + written, output.size() - written, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            std::cerr << "Lost connection to server: " << std::strerror(errno) << std::endl;
+            close();
+            return false;
+        }
+        written += static_cast<std::size_t>(sent);
+    }
+    output.erase(output.begin(), output.begin() + written);
+    return true;
+}
+
+bool NetClient::poll(GameState& mirror) {
+    if (fd < 0 || !flush()) {
+        return false;
+    }
+
+    bool changed = false;
+    uint8_t buffer[4096];
+    while (true) {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received == 0) {
+            std::cerr << "Server closed the connection" << std::endl;
+            close();
+            return changed;
+        }
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "Lost connection to server: " << std::strerror(errno) << std::endl;
+                close();
+                return changed;
+            }
+            // Send the acknowledgements for everything just decoded.
+            flush();
+            return changed;
+        }
+
+        input.append(buffer, static_cast<std::size_t>(received));
+
+        MessageType type;
+        const uint8_t* payload;
+        std::size_t size;
+        while (input.next(type, payload, size)) {
+            if (type == MessageType::Welcome) {
+                WelcomeMessage welcome;
+                if (decodeWelcome(payload, size, welcome)) {
+                    slot = welcome.slot;
+                }
+            } else if ((type == MessageType::Keyframe || type == MessageType::Delta) && size > 0) {
+                // A delta whose base is gone is dropped; the server falls back to a
+                // keyframe once our acknowledgements stop advancing, or for a spectator
+                // once it is too far behind.
+                uint8_t boardSlot = payload[0];
+                if (boardSlot >= boards.size()) {
+                    boards.resize(boardSlot + 1);
+                }
+                SnapshotDecoder& board = boards[boardSlot];
+                if (board.apply(type, payload, size)) {
+                    if (!spectating) {
+                        encodeAck(output, boardSlot, board.getGeneration());
+                    }
+                    if (boardSlot == (spectating ? watched : slot)) {
+                        board.getCurrent().applyTo(mirror);
+                        changed = true;
+                    }
+                }
+            }
+        }
+        if (input.isCorrupt()) {
+            std::cerr << "Malformed data from server" << std::endl;
+            close();
+            return changed;
+        }
+    }
+}
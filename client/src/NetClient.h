@@ -0,0 +1,51 @@
+#ifndef NET_CLIENT_H
+#define NET_CLIENT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Command.h"
+#include "GameState.h"
+#include "Protocol.h"
+#include "Snapshot.h"
+
+// Connection to a tetris_server. Connecting blocks; everything after that is
+// non-blocking and driven by poll() from the game's update thread.
+class NetClient {
+public:
+    NetClient();
+    ~NetClient();
+    NetClient(const NetClient&) = delete;
+    NetClient& operator=(const NetClient&) = delete;
+
+    // A spectator watches the room without a board of its own; see watch().
+    bool connect(const std::string& host, uint16_t port, uint32_t room, bool spectate = false);
+    void close();
+    bool isConnected() const { return fd >= 0; }
+    // -1 until the server's Welcome has arrived, SPECTATOR_SLOT when watching.
+    int getSlot() const { return slot; }
+    bool isSpectating() const { return spectating; }
+    // The board poll() mirrors while spectating.
+    void watch(int boardSlot) { watched = boardSlot; }
+    // Latest decoded state of every board in the room, indexed by slot.
+    const std::vector<SnapshotDecoder>& getBoards() const { return boards; }
+
+    bool send(Command command);
+    // Reads whatever has arrived and applies our own board to `mirror`. Returns true
+    // when it changed; drops the connection if the server closed it.
+    bool poll(GameState& mirror);
+
+private:
+    int fd;
+    int slot;
+    bool spectating;
+    int watched;
+    FrameParser input;
+    std::vector<uint8_t> output;
+    // One decoder per board in the room, indexed by slot.
+    std::vector<SnapshotDecoder> boards;
+
+    bool flush();
+};
+
+#endif
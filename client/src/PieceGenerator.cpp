@@ -0,0 +1,40 @@
+#include <utility>
+#include "PieceGenerator.h"
+
+PieceGenerator::PieceGenerator(uint64_t seed, Randomizer randomizer) {
+    reset(seed, randomizer);
+}
+
+void PieceGenerator::reset(uint64_t seed, Randomizer newRandomizer) {
+    rng.seedWith(seed);
+    randomizer = newRandomizer;
+    bagIndex = TETROMINO_TYPE_COUNT;
+    previewHead = 0;
+    for (auto& piece : preview) {
+        piece = draw();
+    }
+}
+
+TetrominoType PieceGenerator::draw() {
+    if (randomizer == Randomizer::Uniform) {
+        return static_cast<TetrominoType>(rng.nextBelow(TETROMINO_TYPE_COUNT));
+    }
+
+    if (bagIndex == TETROMINO_TYPE_COUNT) {
+        for (int i = 0; i < TETROMINO_TYPE_COUNT; ++i) {
+            bag[i] = static_cast<TetrominoType>(i);
+        }
+        for (int i = TETROMINO_TYPE_COUNT - 1; i > 0; --i) {
+            std::swap(bag[i], bag[rng.nextBelow(static_cast<uint32_t>(i + 1))]);
+        }
+        bagIndex = 0;
+    }
+    return bag[bagIndex++];
+}
+
+TetrominoType PieceGenerator::next() {
+    TetrominoType piece = preview[previewHead];
+    preview[previewHead] = draw();
+    previewHead = (previewHead + 1) % PREVIEW_SIZE;
+    return piece;
+}
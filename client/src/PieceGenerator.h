@@ -0,0 +1,39 @@
+#ifndef PIECE_GENERATOR_H
+#define PIECE_GENERATOR_H
+
+#include <cstdint>
+#include "Random.h"
+#include "Tetromino.h"
+
+enum class Randomizer : uint8_t {
+    Uniform,   // every piece drawn independently, like the original rand() % 7
+    SevenBag   // each run of seven pieces is a shuffled permutation of all types
+};
+
+// Seeded source of upcoming pieces with a fixed-size preview queue. Identical seeds and
+// randomizers always produce identical sequences.
+class PieceGenerator {
+public:
+    static constexpr int PREVIEW_SIZE = 6;
+
+    explicit PieceGenerator(uint64_t seed = 0, Randomizer randomizer = Randomizer::Uniform);
+
+    void reset(uint64_t seed, Randomizer newRandomizer);
+    Randomizer getRandomizer() const { return randomizer; }
+
+    TetrominoType next();
+    // Upcoming piece `index` places ahead (0 is what next() returns).
+    TetrominoType peek(int index) const { return preview[(previewHead + index) % PREVIEW_SIZE]; }
+
+private:
+    Xoshiro256 rng;
+    Randomizer randomizer;
+    TetrominoType bag[TETROMINO_TYPE_COUNT];
+    int bagIndex;
+    TetrominoType preview[PREVIEW_SIZE];
+    int previewHead;
+
+    TetrominoType draw();
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef PLAYFIELD_H
+#define PLAYFIELD_H
+
+#include <algorithm>
+#include "Board.h"
+#include "Tetromino.h"
+
+// Window geometry shared by the SDL and software renderers; no SDL dependency, so the
+// headless tools can lay out frames exactly as the client does.
+//
+// Every board is drawn into a playfield of this size next to the score panel. Cells shrink
+// from CELL_SIZE to fit the board, but not below MIN_CELL_SIZE; taller boards scroll.
+const int PLAYFIELD_WIDTH = 300;
+const int PLAYFIELD_HEIGHT = 600;
+const int CELL_SIZE = 30;
+const int MIN_CELL_SIZE = 6;
+const int SCORE_AREA_WIDTH = 200;
+const int SCORE_AREA_X = PLAYFIELD_WIDTH;
+const int SCORE_Y = 50;
+const int WINDOW_WIDTH = PLAYFIELD_WIDTH + SCORE_AREA_WIDTH;
+const int WINDOW_HEIGHT = PLAYFIELD_HEIGHT;
+
+// Where the visible part of a board goes inside the playfield.
+struct PlayfieldLayout {
+    int cols = 0;
+    int visibleRows = 0;
+    int cellSize = 0;
+    int x = 0;
+    int y = 0;
+
+    static PlayfieldLayout of(const Board& board) {
+        PlayfieldLayout layout;
+        layout.cols = board.getCols();
+        layout.cellSize = std::min({CELL_SIZE, PLAYFIELD_WIDTH / layout.cols,
+                                    std::max(MIN_CELL_SIZE, PLAYFIELD_HEIGHT / board.getRows())});
+        layout.visibleRows = std::min(board.getRows(), PLAYFIELD_HEIGHT / layout.cellSize);
+        // Centred across the playfield, resting on its bottom edge.
+        layout.x = (PLAYFIELD_WIDTH - layout.cols * layout.cellSize) / 2;
+        layout.y = PLAYFIELD_HEIGHT - layout.visibleRows * layout.cellSize;
+        return layout;
+    }
+
+    bool operator==(const PlayfieldLayout& other) const {
+        return cols == other.cols && visibleRows == other.visibleRows && cellSize == other.cellSize;
+    }
+    bool operator!=(const PlayfieldLayout& other) const { return !(*this == other); }
+
+    // Boards taller than the playfield show the rows around the falling piece.
+    int firstVisibleRow(const Board& board, const Tetromino& piece) const {
+        return std::clamp(piece.getPosition().y + piece.getShape().height / 2 - visibleRows / 2, 0,
+                          board.getRows() - visibleRows);
+    }
+};
+
+#endif
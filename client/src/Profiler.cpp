@@ -0,0 +1,171 @@
+#include "Profiler.h"
+
+#ifdef TETRIS_PROFILE
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SpscQueue.h"
+
+namespace profiler {
+
+namespace {
+
+struct Event {
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+constexpr std::size_t BUFFER_CAPACITY = 1 << 14;
+constexpr std::chrono::milliseconds FLUSH_PERIOD{10};
+
+// Written only by its thread, drained only by the flusher. Owned by the registry so
+// events from threads that have already exited still get written.
+struct ThreadBuffer {
+    int threadId = 0;
+    std::atomic<const char*> name{nullptr};
+    bool nameWritten = false;
+    std::atomic<uint64_t> dropped{0};
+    SpscQueue<Event, BUFFER_CAPACITY> events;
+};
+
+struct Session {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::FILE* file = nullptr;
+    bool firstEvent = true;
+    std::atomic<bool> active{false};
+
+    std::thread flusher;
+    std::mutex flusherMutex;
+    std::condition_variable flusherWake;
+    bool stopping = false;
+};
+
+Session session;
+const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+thread_local ThreadBuffer* localBuffer = nullptr;
+
+ThreadBuffer& threadBuffer() {
+    if (!localBuffer) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(session.mutex);
+        buffer->threadId = static_cast<int>(session.buffers.size()) + 1;
+        session.buffers.push_back(buffer);
+        localBuffer = buffer.get();
+    }
+    return *localBuffer;
+}
+
+void writeSeparator() {
+    std::fputs(session.firstEvent ? "\n" : ",\n", session.file);
+    session.firstEvent = false;
+}
+
+// Caller holds session.mutex.
+void drain() {
+    for (auto& buffer : session.buffers) {
+        const char* name = buffer->name.load(std::memory_order_acquire);
+        if (name && !buffer->nameWritten) {
+            writeSeparator();
+            std::fprintf(session.file,
+                         "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                         buffer->threadId, name);
+            buffer->nameWritten = true;
+        }
+
+        Event event;
+        while (buffer->events.pop(event)) {
+            writeSeparator();
+            std::fprintf(session.file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                         event.name, buffer->threadId, event.begin / 1000.0, (event.end - event.begin) / 1000.0);
+        }
+    }
+}
+
+void flushLoop() {
+    std::unique_lock<std::mutex> wakeLock(session.flusherMutex);
+    while (!session.stopping) {
+        session.flusherWake.wait_for(wakeLock, FLUSH_PERIOD);
+        std::lock_guard<std::mutex> lock(session.mutex);
+        drain();
+    }
+}
+
+}
+
+uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void start(const char* path) {
+    std::lock_guard<std::mutex> lock(session.mutex);
+    if (session.file) {
+        return;
+    }
+
+    session.file = std::fopen(path, "w");
+    if (!session.file) {
+        std::cerr << "Failed to open trace file: " << path << std::endl;
+        return;
+    }
+    std::fputs("{\"traceEvents\":[", session.file);
+    session.firstEvent = true;
+    session.stopping = false;
+    session.active = true;
+    session.flusher = std::thread(flushLoop);
+}
+
+void stop() {
+    if (!session.active.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> wakeLock(session.flusherMutex);
+        session.stopping = true;
+    }
+    session.flusherWake.notify_one();
+    session.flusher.join();
+
+    std::lock_guard<std::mutex> lock(session.mutex);
+    drain();
+
+    uint64_t dropped = 0;
+    for (auto& buffer : session.buffers) {
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    if (dropped > 0) {
+        std::cerr << "Profiler dropped " << dropped << " zones; buffers were full" << std::endl;
+    }
+
+    std::fputs("\n]}\n", session.file);
+    std::fclose(session.file);
+    session.file = nullptr;
+}
+
+void setThreadName(const char* name) {
+    threadBuffer().name.store(name, std::memory_order_release);
+}
+
+// Zones are recorded as complete ("X") events carrying both their begin and end time, so
+// a zone dropped on a full buffer never leaves an unmatched begin in the trace.
+void recordZone(const char* name, uint64_t begin, uint64_t end) {
+    if (!session.active.load(std::memory_order_relaxed)) {
+        return;
+    }
+    ThreadBuffer& buffer = threadBuffer();
+    if (!buffer.events.push({name, begin, end})) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Scoped profiling zones written as Chrome Trace Event JSON (chrome://tracing, Perfetto).
+// Build with -DTETRIS_PROFILE and link Profiler.cpp to enable; otherwise every macro
+// below expands to nothing and Profiler.cpp compiles to an empty object.
+//
+//   PROFILE_START("trace.json");   // once, starts the background flusher
+//   PROFILE_THREAD("worker");      // optional name for the calling thread
+//   PROFILE_ZONE("Game::update");  // times the enclosing scope; name must be a literal
+//   PROFILE_STOP();                // flushes and closes the file
+
+#ifdef TETRIS_PROFILE
+
+#include <cstdint>
+
+namespace profiler {
+
+void start(const char* path);
+void stop();
+void setThreadName(const char* name);
+uint64_t now();
+void recordZone(const char* name, uint64_t begin, uint64_t end);
+
+class Zone {
+public:
+    explicit Zone(const char* name) : name(name), begin(now()) {}
+    ~Zone() { recordZone(name, begin, now()); }
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+
+private:
+    const char* name;
+    uint64_t begin;
+};
+
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_START(path) profiler::start(path)
+#define PROFILE_STOP() profiler::stop()
+#define PROFILE_THREAD(name) profiler::setThreadName(name)
+#define PROFILE_ZONE(name) profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+
+#else
+
+#define PROFILE_START(path) ((void)0)
+#define PROFILE_STOP() ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#define PROFILE_ZONE(name) ((void)0)
+
+#endif
+
+#endif
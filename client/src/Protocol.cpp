@@ -0,0 +1,138 @@
+#include <cstring>
+#include "Protocol.h"
+
+namespace {
+
+const std::size_t WELCOME_SIZE = 4 + 1 + 8;
+const std::size_t ACK_SIZE = 1 + 4;
+
+void putLittleEndian(uint8_t* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint64_t getLittleEndian(const uint8_t* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+// Appends the frame header and returns a pointer to `payloadSize` bytes to fill in.
+uint8_t* beginFrame(std::vector<uint8_t>& out, MessageType type, std::size_t payloadSize) {
+    std::size_t start = out.size();
+    out.resize(start + FRAME_HEADER_SIZE + payloadSize);
+    uint8_t* frame = out.data() + start;
+    putLittleEndian(frame, payloadSize + 1, 2);
+    frame[2] = static_cast<uint8_t>(type);
+    return frame + FRAME_HEADER_SIZE;
+}
+
+}
+
+void encodeFrame(std::vector<uint8_t>& out, MessageType type, const uint8_t* payload, std::size_t size) {
+    std::memcpy(beginFrame(out, type, size), payload, size);
+}
+
+void encodeJoin(std::vector<uint8_t>& out, uint32_t room) {
+    putLittleEndian(beginFrame(out, MessageType::Join, 4), room, 4);
+}
+
+void encodeSpectate(std::vector<uint8_t>& out, uint32_t room) {
+    putLittleEndian(beginFrame(out, MessageType::Spectate, 4), room, 4);
+}
+
+void encodeInput(std::vector<uint8_t>& out, Command command) {
+    *beginFrame(out, MessageType::Input, 1) = static_cast<uint8_t>(command);
+}
+
+void encodeAck(std::vector<uint8_t>& out, uint8_t slot, uint32_t generation) {
+    uint8_t* payload = beginFrame(out, MessageType::Ack, ACK_SIZE);
+    payload[0] = slot;
+    putLittleEndian(payload + 1, generation, 4);
+}
+
+void encodeWelcome(std::vector<uint8_t>& out, const WelcomeMessage& message) {
+    uint8_t* payload = beginFrame(out, MessageType::Welcome, WELCOME_SIZE);
+    putLittleEndian(payload, message.room, 4);
+    payload[4] = message.slot;
+    putLittleEndian(payload + 5, message.seed, 8);
+}
+
+bool decodeJoin(const uint8_t* payload, std::size_t size, uint32_t& room) {
+    if (size != 4) {
+        return false;
+    }
+    room = static_cast<uint32_t>(getLittleEndian(payload, 4));
+    return true;
+}
+
+bool decodeSpectate(const uint8_t* payload, std::size_t size, uint32_t& room) {
+    return decodeJoin(payload, size, room);
+}
+
+bool decodeInput(const uint8_t* payload, std::size_t size, Command& command) {
+    if (size != 1 || payload[0] >= COMMAND_COUNT) {
+        return false;
+    }
+    command = static_cast<Command>(payload[0]);
+    return true;
+}
+
+bool decodeAck(const uint8_t* payload, std::size_t size, uint8_t& slot, uint32_t& generation) {
+    if (size != ACK_SIZE) {
+        return false;
+    }
+    slot = payload[0];
+    generation = static_cast<uint32_t>(getLittleEndian(payload + 1, 4));
+    return true;
+}
+
+bool decodeWelcome(const uint8_t* payload, std::size_t size, WelcomeMessage& message) {
+    if (size != WELCOME_SIZE) {
+        return false;
+    }
+    message.room = static_cast<uint32_t>(getLittleEndian(payload, 4));
+    message.slot = payload[4];
+    message.seed = getLittleEndian(payload + 5, 8);
+    return true;
+}
+
+FrameParser::FrameParser()
+    : offset(0),
+      corrupt(false) {
+}
+
+void FrameParser::append(const uint8_t* data, std::size_t size) {
+    // Drop consumed bytes before growing, so the buffer stays bounded by one frame plus
+    // whatever arrived in the last read.
+    if (offset > 0) {
+        buffer.erase(buffer.begin(), buffer.begin() + offset);
+        offset = 0;
+    }
+    buffer.insert(buffer.end(), data, data + size);
+}
+
+bool FrameParser::next(MessageType& type, const uint8_t*& payload, std::size_t& size) {
+    if (corrupt || buffer.size() - offset < FRAME_HEADER_SIZE) {
+        return false;
+    }
+
+    const uint8_t* frame = buffer.data() + offset;
+    std::size_t length = static_cast<std::size_t>(getLittleEndian(frame, 2));
+    if (length == 0 || length > MAX_FRAME_SIZE) {
+        corrupt = true;
+        return false;
+    }
+    if (buffer.size() - offset < 2 + length) {
+        return false;
+    }
+
+    type = static_cast<MessageType>(frame[2]);
+    payload = frame + FRAME_HEADER_SIZE;
+    size = length - 1;
+    offset += 2 + length;
+    return true;
+}
@@ -0,0 +1,74 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Command.h"
+
+// Wire format shared by tetris_server and its clients. Every message is one frame:
+//
+//   uint16 length (of type + payload), uint8 type, payload    (integers little endian)
+//
+//   Join      client -> server   uint32 room
+//   Input     client -> server   uint8 command
+//   Ack       client -> server   uint8 slot, uint32 generation of that board now held
+//   Spectate  client -> server   uint32 room; watch every board there without playing
+//   Welcome   server -> client   uint32 room, uint8 slot (SPECTATOR_SLOT when watching), uint64 seed
+//   Keyframe  server -> client   a whole board, see SnapshotEncoder
+//   Delta     server -> client   what changed since the acknowledged generation
+
+enum class MessageType : uint8_t {
+    Join = 1,
+    Input = 2,
+    Welcome = 3,
+    Keyframe = 4,
+    Delta = 5,
+    Ack = 6,
+    Spectate = 7,
+};
+
+constexpr std::size_t FRAME_HEADER_SIZE = 3;
+// Frames above this are rejected; the connection sending them is dropped.
+constexpr std::size_t MAX_FRAME_SIZE = 1024;
+// Welcome slot of a spectator, who has no board of their own.
+constexpr uint8_t SPECTATOR_SLOT = 0xFF;
+
+struct WelcomeMessage {
+    uint32_t room;
+    uint8_t slot;
+    uint64_t seed;
+};
+
+void encodeFrame(std::vector<uint8_t>& out, MessageType type, const uint8_t* payload, std::size_t size);
+void encodeJoin(std::vector<uint8_t>& out, uint32_t room);
+void encodeSpectate(std::vector<uint8_t>& out, uint32_t room);
+void encodeInput(std::vector<uint8_t>& out, Command command);
+void encodeAck(std::vector<uint8_t>& out, uint8_t slot, uint32_t generation);
+void encodeWelcome(std::vector<uint8_t>& out, const WelcomeMessage& message);
+
+// Payload decoders; false when the payload is malformed.
+bool decodeJoin(const uint8_t* payload, std::size_t size, uint32_t& room);
+bool decodeSpectate(const uint8_t* payload, std::size_t size, uint32_t& room);
+bool decodeInput(const uint8_t* payload, std::size_t size, Command& command);
+bool decodeAck(const uint8_t* payload, std::size_t size, uint8_t& slot, uint32_t& generation);
+bool decodeWelcome(const uint8_t* payload, std::size_t size, WelcomeMessage& message);
+
+// Reassembles frames from a byte stream that arrives in arbitrary pieces.
+class FrameParser {
+public:
+    FrameParser();
+
+    void append(const uint8_t* data, std::size_t size);
+    // Yields the next complete frame. The payload pointer stays valid until the next
+    // append(). Returns false when no full frame is buffered or the stream is corrupt.
+    bool next(MessageType& type, const uint8_t*& payload, std::size_t& size);
+    bool isCorrupt() const { return corrupt; }
+
+private:
+    std::vector<uint8_t> buffer;
+    std::size_t offset;
+    bool corrupt;
+};
+
+#endif
@@ -0,0 +1,212 @@
+#include <cstring>
+#include "Replay.h"
+
+namespace {
+
+const char REPLAY_MAGIC[4] = {'T', 'R', 'P', 'L'};
+// Version 3: lock delay is timed on its own instead of waiting for the next gravity step,
+// so older logs no longer play back to the same game. Version 4 adds the board size.
+const uint8_t REPLAY_VERSION = 4;
+const uint64_t END_MARKER = 7;
+const int COMMAND_BITS = 3;
+const std::size_t HEADER_SIZE = 4 + 1 + 1 + 8 + 4 + 2 + 1;
+
+static_assert(COMMAND_COUNT <= static_cast<int>(END_MARKER), "commands must fit below the end marker");
+
+void putLittleEndian(uint8_t* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint64_t getLittleEndian(const uint8_t* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+}
+
+ReplayWriter::ReplayWriter()
+    : file(nullptr),
+      lastTick(0),
+      failed(false) {
+}
+
+ReplayWriter::~ReplayWriter() {
+    close(lastTick);
+}
+
+bool ReplayWriter::open(const std::string& path, uint64_t seed, Randomizer randomizer, uint32_t tickMs,
+                        BoardSize boardSize) {
+    close(lastTick);
+
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    buffer.clear();
+    buffer.reserve(BUFFER_SIZE);
+    lastTick = 0;
+    failed = false;
+
+    uint8_t header[HEADER_SIZE];
+    std::memcpy(header, REPLAY_MAGIC, 4);
+    header[4] = REPLAY_VERSION;
+    header[5] = static_cast<uint8_t>(randomizer);
+    putLittleEndian(header + 6, seed, 8);
+    putLittleEndian(header + 14, tickMs, 4);
+    putLittleEndian(header + 18, static_cast<uint64_t>(boardSize.rows), 2);
+    header[20] = static_cast<uint8_t>(boardSize.cols);
+    if (std::fwrite(header, 1, HEADER_SIZE, file) != HEADER_SIZE) {
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void ReplayWriter::writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+
+    if (buffer.size() >= BUFFER_SIZE - 16) {
+        flush();
+    }
+}
+
+void ReplayWriter::flush() {
+    if (file && !buffer.empty() && std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+        failed = true;
+    }
+    buffer.clear();
+}
+
+void ReplayWriter::record(uint32_t tick, Command command) {
+    if (!file) {
+        return;
+    }
+    uint64_t delta = tick - lastTick;
+    lastTick = tick;
+    writeVarint((delta << COMMAND_BITS) | static_cast<uint64_t>(command));
+}
+
+bool ReplayWriter::close(uint32_t finalTick) {
+    if (!file) {
+        return !failed;
+    }
+    uint64_t delta = finalTick >= lastTick ? finalTick - lastTick : 0;
+    writeVarint((delta << COMMAND_BITS) | END_MARKER);
+    flush();
+    if (std::fclose(file) != 0) {
+        failed = true;
+    }
+    file = nullptr;
+    return !failed;
+}
+
+ReplayReader::ReplayReader()
+    : file(nullptr),
+      position(0),
+      available(0),
+      seed(0),
+      randomizer(Randomizer::Uniform),
+      tickMs(0),
+      boardSize(Board::DEFAULT_SIZE),
+      tick(0),
+      finished(true) {
+}
+
+ReplayReader::~ReplayReader() {
+    if (file) {
+        std::fclose(file);
+    }
+}
+
+bool ReplayReader::open(const std::string& path) {
+    if (file) {
+        std::fclose(file);
+    }
+    file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    buffer.resize(BUFFER_SIZE);
+    position = 0;
+    available = 0;
+    tick = 0;
+    finished = false;
+
+    uint8_t header[HEADER_SIZE];
+    for (auto& byte : header) {
+        if (!readByte(byte)) {
+            finished = true;
+            return false;
+        }
+    }
+    // A zero tick length would divide by zero in Simulator::tick().
+    uint32_t headerTickMs = static_cast<uint32_t>(getLittleEndian(header + 14, 4));
+    if (std::memcmp(header, REPLAY_MAGIC, 4) != 0 || header[4] != REPLAY_VERSION ||
+        header[5] > static_cast<uint8_t>(Randomizer::SevenBag) || headerTickMs == 0) {
+        finished = true;
+        return false;
+    }
+    randomizer = static_cast<Randomizer>(header[5]);
+    seed = getLittleEndian(header + 6, 8);
+    tickMs = headerTickMs;
+    boardSize = {static_cast<int>(getLittleEndian(header + 18, 2)), header[20]};
+    return true;
+}
+
+bool ReplayReader::readByte(uint8_t& byte) {
+    if (position == available) {
+        available = file ? std::fread(buffer.data(), 1, buffer.size(), file) : 0;
+        position = 0;
+        if (available == 0) {
+            return false;
+        }
+    }
+    byte = buffer[position++];
+    return true;
+}
+
+bool ReplayReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte;
+        if (!readByte(byte)) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ReplayReader::next(ReplayEvent& event) {
+    uint64_t value;
+    if (finished || !readVarint(value)) {
+        finished = true;
+        return false;
+    }
+
+    tick += static_cast<uint32_t>(value >> COMMAND_BITS);
+    uint64_t command = value & ((1u << COMMAND_BITS) - 1);
+    if (command == END_MARKER || command >= static_cast<uint64_t>(COMMAND_COUNT)) {
+        finished = true;
+        return false;
+    }
+
+    event.tick = tick;
+    event.command = static_cast<Command>(command);
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Board.h"
+#include "Command.h"
+#include "PieceGenerator.h"
+
+// Binary replay log: a fixed header followed by one varint per command.
+//
+//   header: "TRPL", uint8 version, uint8 randomizer, uint64 seed, uint32 tick length in ms,
+//           uint16 board rows, uint8 board columns (integers little endian)
+//   record: varint((tickDelta << 3) | command)
+//
+// Commands take the low three bits; END_MARKER closes the log and carries the ticks that
+// passed after the last command. Most records fit in a single byte.
+
+struct ReplayEvent {
+    uint32_t tick;
+    Command command;
+};
+
+class ReplayWriter {
+public:
+    ReplayWriter();
+    ~ReplayWriter();
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+
+    bool open(const std::string& path, uint64_t seed, Randomizer randomizer, uint32_t tickMs,
+              BoardSize boardSize = Board::DEFAULT_SIZE);
+    bool isOpen() const { return file != nullptr; }
+    void record(uint32_t tick, Command command);
+    // False if any write since open() failed, e.g. on a full disk; the log is then
+    // truncated.
+    bool close(uint32_t finalTick);
+
+private:
+    static constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+
+    std::FILE* file;
+    std::vector<uint8_t> buffer;
+    uint32_t lastTick;
+    bool failed;
+
+    void writeVarint(uint64_t value);
+    void flush();
+};
+
+class ReplayReader {
+public:
+    ReplayReader();
+    ~ReplayReader();
+    ReplayReader(const ReplayReader&) = delete;
+    ReplayReader& operator=(const ReplayReader&) = delete;
+
+    bool open(const std::string& path);
+    uint64_t getSeed() const { return seed; }
+    Randomizer getRandomizer() const { return randomizer; }
+    uint32_t getTickMs() const { return tickMs; }
+    BoardSize getBoardSize() const { return boardSize; }
+    // Tick of the END_MARKER, valid once next() has returned false.
+    uint32_t getFinalTick() const { return tick; }
+
+    bool next(ReplayEvent& event);
+
+private:
+    static constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+
+    std::FILE* file;
+    std::vector<uint8_t> buffer;
+    std::size_t position;
+    std::size_t available;
+    uint64_t seed;
+    Randomizer randomizer;
+    uint32_t tickMs;
+    BoardSize boardSize;
+    uint32_t tick;
+    bool finished;
+
+    bool readByte(uint8_t& byte);
+    bool readVarint(uint64_t& value);
+};
+
+#endif
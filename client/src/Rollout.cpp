@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cmath>
+#include "FixedBoard.h"
+#include "GameState.h"
+#include "Random.h"
+#include "Rollout.h"
+
+namespace {
+
+struct BatchTotals {
+    double score = 0;
+    double scoreSquares = 0;
+    int survived = 0;
+    long long pieces = 0;
+};
+
+}
+
+RolloutEvaluator::RolloutEvaluator(WorkerPool* pool, const BotWeights& policy)
+    : policy(policy),
+      pool(pool) {
+}
+
+std::vector<RolloutStats> RolloutEvaluator::evaluate(const Board& board, const std::vector<Tetromino>& placements,
+                                                     const RolloutOptions& options) const {
+    if (StandardBoard::fits(board)) {
+        return run(StandardBoard(board), placements, options);
+    }
+    return run(board, placements, options);
+}
+
+template <typename BoardType>
+std::vector<RolloutStats> RolloutEvaluator::run(const BoardType& board, const std::vector<Tetromino>& placements,
+                                                const RolloutOptions& options) const {
+    const int placementCount = static_cast<int>(placements.size());
+    const int rollouts = std::max(1, options.rollouts);
+    const int batchesPerPlacement = (rollouts + BATCH_SIZE - 1) / BATCH_SIZE;
+
+    std::vector<BoardType> starts(placementCount, board);
+    std::vector<int> startLines(placementCount);
+    for (int i = 0; i < placementCount; ++i) {
+        starts[i].mergeTetromino(placements[i]);
+        startLines[i] = starts[i].clearLines();
+    }
+
+    // Neighbouring option seeds must not share piece sequences, so the per-rollout seeds
+    // are offsets from a hash of the option seed rather than from the seed itself.
+    const uint64_t seedBase = Xoshiro256(options.seed).next();
+
+    // Each batch writes only its own totals; they are summed in order afterwards, so the
+    // floating-point result is the same however the batches were scheduled.
+    std::vector<BatchTotals> totals(placementCount * batchesPerPlacement);
+    auto playBatch = [&](int batch) {
+        const int placement = batch / batchesPerPlacement;
+        const int first = (batch % batchesPerPlacement) * BATCH_SIZE;
+        const int last = std::min(rollouts, first + BATCH_SIZE);
+
+        BatchTotals sum;
+        BoardType play = starts[placement];
+        PieceGenerator pieces;
+        for (int rollout = first; rollout < last; ++rollout) {
+            play = starts[placement];
+            pieces.reset(seedBase + rollout, options.randomizer);
+            int lines = startLines[placement];
+            int placed = 0;
+            while (placed < options.depth) {
+                Tetromino piece = GameState::makeSpawnTetromino(pieces.next(), play.getCols());
+                int cleared = policy.placeGreedy(play, piece);
+                if (cleared < 0) {
+                    break;
+                }
+                lines += cleared;
+                placed++;
+            }
+
+            double score = static_cast<double>(lines) * GameState::POINTS_PER_LINE;
+            sum.score += score;
+            sum.scoreSquares += score * score;
+            sum.survived += placed == options.depth ? 1 : 0;
+            sum.pieces += placed;
+        }
+        totals[batch] = sum;
+    };
+
+    const int batchCount = static_cast<int>(totals.size());
+    if (pool && batchCount > 1) {
+        pool->parallelFor(batchCount, playBatch);
+    } else {
+        for (int batch = 0; batch < batchCount; ++batch) {
+            playBatch(batch);
+        }
+    }
+
+    std::vector<RolloutStats> results(placementCount);
+    for (int i = 0; i < placementCount; ++i) {
+        BatchTotals sum;
+        for (int batch = i * batchesPerPlacement; batch < (i + 1) * batchesPerPlacement; ++batch) {
+            sum.score += totals[batch].score;
+            sum.scoreSquares += totals[batch].scoreSquares;
+            sum.survived += totals[batch].survived;
+            sum.pieces += totals[batch].pieces;
+        }
+        RolloutStats& stats = results[i];
+        stats.meanScore = sum.score / rollouts;
+        stats.scoreStdDev = std::sqrt(std::max(0.0, sum.scoreSquares / rollouts - stats.meanScore * stats.meanScore));
+        stats.survivalRate = static_cast<double>(sum.survived) / rollouts;
+        stats.meanPieces = static_cast<double>(sum.pieces) / rollouts;
+    }
+    return results;
+}
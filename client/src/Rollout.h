@@ -0,0 +1,57 @@
+#ifndef ROLLOUT_H
+#define ROLLOUT_H
+
+#include <cstdint>
+#include <vector>
+#include "Board.h"
+#include "Bot.h"
+#include "PieceGenerator.h"
+#include "Tetromino.h"
+#include "WorkerPool.h"
+
+struct RolloutOptions {
+    // Random piece sequences played out per placement. Rollout n uses the same sequence for
+    // every placement, so the placements are compared on equal terms.
+    int rollouts = 256;
+    // Pieces played after the placement being graded.
+    int depth = 50;
+    uint64_t seed = 1;
+    Randomizer randomizer = Randomizer::Uniform;
+};
+
+struct RolloutStats {
+    // Points scored from the placement on, including the lines it clears itself.
+    double meanScore = 0;
+    double scoreStdDev = 0;
+    // Share of rollouts that placed all `depth` pieces without topping out.
+    double survivalRate = 0;
+    // Pieces placed before topping out, `depth` for a survivor.
+    double meanPieces = 0;
+};
+
+// Monte Carlo grading of placements. Each one is played out over many sampled futures by
+// the bot's greedy one-piece policy, and the outcomes are summarized. The rollouts are cut
+// into batches that the caller and WorkerPool helpers claim as they go idle. Every rollout
+// draws its pieces from its own seeded generator, so the results do not depend on the
+// number of threads.
+class RolloutEvaluator {
+public:
+    static constexpr int BATCH_SIZE = 8;
+
+    explicit RolloutEvaluator(WorkerPool* pool = nullptr, const BotWeights& policy = BotWeights());
+
+    // `placements` are resting places of the current piece on `board`, e.g. the targets
+    // from Bot::listPlacements(); one result is returned per placement, in order.
+    std::vector<RolloutStats> evaluate(const Board& board, const std::vector<Tetromino>& placements,
+                                       const RolloutOptions& options) const;
+
+private:
+    Bot policy;
+    WorkerPool* pool;
+
+    template <typename BoardType>
+    std::vector<RolloutStats> run(const BoardType& board, const std::vector<Tetromino>& placements,
+                                  const RolloutOptions& options) const;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include <cstdlib>
+#include "Simulator.h"
+
+Simulator::Simulator(uint32_t tickMs, uint64_t seed, Randomizer randomizer, BoardSize boardSize)
+    : now(0),
+      tickMs(tickMs),
+      ticks(0),
+      recorder(nullptr) {
+    state.setRandomizer(randomizer);
+    state.setBoardSize(boardSize);
+    state.reset(seed);
+}
+
+void Simulator::reset(uint64_t seed) {
+    now = 0;
+    ticks = 0;
+    state.reset(seed);
+}
+
+void Simulator::restore(const Checkpoint& checkpoint) {
+    state = checkpoint.state;
+    now = checkpoint.now;
+    ticks = checkpoint.ticks;
+}
+
+void Simulator::apply(Command command) {
+    if (recorder) {
+        recorder->record(ticks, command);
+    }
+    state.handleInput(command);
+}
+
+void Simulator::tick() {
+    now += tickMs;
+    ticks++;
+    state.update(now);
+}
+
+// Same result as calling tick() count times: update() is a no-op before the next
+// deadline, so only the tick that reaches it is run.
+int Simulator::tick(int count) {
+    int updates = 0;
+    uint32_t remaining = count > 0 ? static_cast<uint32_t>(count) : 0;
+
+    while (remaining > 0 && !state.isGameOver()) {
+        uint32_t deadline = getNextDeadline();
+        uint32_t idle = deadline == GameState::NO_DEADLINE ? remaining : (deadline - now) / tickMs - 1;
+        if (idle >= remaining) {
+            now += remaining * tickMs;
+            ticks += remaining;
+            break;
+        }
+
+        now += idle * tickMs;
+        ticks += idle;
+        remaining -= idle + 1;
+        tick();
+        updates++;
+    }
+    return updates;
+}
+
+uint32_t Simulator::getNextDeadline() const {
+    uint32_t deadline = state.getNextDeadline();
+    if (deadline == GameState::NO_DEADLINE) {
+        return deadline;
+    }
+    if (deadline <= now + tickMs) {
+        return now + tickMs;
+    }
+    return now + (deadline - now + tickMs - 1) / tickMs * tickMs;
+}
+
+// Script lines are either a command name (see parseCommand), applied on the current
+// tick, or "TICK n" to let n ticks pass. Every command also ends its tick; unknown
+// lines are skipped.
+void Simulator::run(const std::vector<std::string>& commands) {
+    for (const auto& line : commands) {
+        if (state.isGameOver()) {
+            break;
+        }
+        Command command;
+        if (line.compare(0, 5, "TICK ") == 0) {
+            tick(std::atoi(line.c_str() + 5));
+        } else if (parseCommand(line, command)) {
+            apply(command);
+            tick();
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "GameState.h"
+#include "Replay.h"
+
+// Runs a GameState on a logical clock: every tick() advances time by a fixed step,
+// so a game can be played back from a command stream as fast as the CPU allows.
+// tick(count) skips straight over ticks on which nothing is due.
+class Simulator {
+public:
+    // Everything needed to resume from a point in time: the game and the logical clock.
+    // Cheap to take and to restore, see GameState.
+    struct Checkpoint {
+        GameState state;
+        uint32_t now;
+        uint32_t ticks;
+    };
+
+private:
+    GameState state;
+    uint32_t now;
+    uint32_t tickMs;
+    uint32_t ticks;
+    ReplayWriter* recorder;
+
+public:
+    static constexpr uint32_t DEFAULT_TICK_MS = 16;
+
+    explicit Simulator(uint32_t tickMs = DEFAULT_TICK_MS, uint64_t seed = 0, Randomizer randomizer = Randomizer::Uniform,
+                       BoardSize boardSize = Board::DEFAULT_SIZE);
+
+    GameState& getState() { return state; }
+    const GameState& getState() const { return state; }
+    uint32_t getTime() const { return now; }
+    uint32_t getTickMs() const { return tickMs; }
+    uint32_t getTickCount() const { return ticks; }
+
+    // Every applied command is also written to the recorder until it is detached with nullptr.
+    void setRecorder(ReplayWriter* writer) { recorder = writer; }
+
+    Checkpoint save() const { return {state, now, ticks}; }
+    // Rolls back to a saved point, e.g. to replay late inputs. The recorder and tick
+    // length are left as they are.
+    void restore(const Checkpoint& checkpoint);
+
+    void reset(uint64_t seed);
+    void apply(Command command);
+    void tick();
+    // Returns how many of the ticks actually changed the game.
+    int tick(int count);
+    // First tick time at which the game will change on its own, or GameState::NO_DEADLINE.
+    uint32_t getNextDeadline() const;
+    void run(const std::vector<std::string>& commands);
+};
+
+#endif
@@ -0,0 +1,297 @@
+#include <cstring>
+#include "Snapshot.h"
+
+namespace {
+
+const uint8_t FIELD_PIECE = 1;
+const uint8_t FIELD_FLAGS = 2;
+const uint8_t FIELD_SCORE = 4;
+const uint8_t FIELD_COUNTERS = 8;
+const uint8_t FIELD_ROWS = 16;
+const uint8_t ALL_FIELDS = FIELD_PIECE | FIELD_FLAGS | FIELD_SCORE | FIELD_COUNTERS | FIELD_ROWS;
+
+const int ROW_MASK_BYTES = (Snapshot::ROWS + 7) / 8;
+// slot, three varints, fields, piece, flags, three varints, row mask, every row.
+const std::size_t MAX_PAYLOAD = 1 + 3 * 5 + 1 + 3 + 1 + 3 * 5 + ROW_MASK_BYTES + 2 * Snapshot::ROWS;
+
+const Snapshot EMPTY_SNAPSHOT;
+
+class Writer {
+public:
+    explicit Writer(uint8_t* out) : out(out), size(0) {}
+
+    void byte(uint8_t value) { out[size++] = value; }
+
+    void varint(uint32_t value) {
+        while (value >= 0x80) {
+            out[size++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        out[size++] = static_cast<uint8_t>(value);
+    }
+
+    uint8_t* out;
+    std::size_t size;
+};
+
+class Reader {
+public:
+    Reader(const uint8_t* in, std::size_t size) : in(in), size(size), offset(0), failed(false) {}
+
+    uint8_t byte() {
+        if (offset >= size) {
+            failed = true;
+            return 0;
+        }
+        return in[offset++];
+    }
+
+    uint32_t varint() {
+        uint32_t value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            uint8_t next = byte();
+            value |= static_cast<uint32_t>(next & 0x7F) << shift;
+            if (!(next & 0x80)) {
+                return value;
+            }
+        }
+        failed = true;
+        return 0;
+    }
+
+    bool done() const { return !failed && offset == size; }
+
+    const uint8_t* in;
+    std::size_t size;
+    std::size_t offset;
+    bool failed;
+};
+
+// Writes `fields` of `current` that differ from `base`, after the generation header.
+void writeFields(Writer& writer, const Snapshot& current, const Snapshot& base, uint8_t fields) {
+    if (current.pieceType != base.pieceType || current.rotation != base.rotation ||
+        current.x != base.x || current.y != base.y) {
+        fields |= FIELD_PIECE;
+    }
+    if (current.gameOver != base.gameOver || current.paused != base.paused) {
+        fields |= FIELD_FLAGS;
+    }
+    if (current.score != base.score) {
+        fields |= FIELD_SCORE;
+    }
+    if (current.piecesPlaced != base.piecesPlaced || current.linesCleared != base.linesCleared) {
+        fields |= FIELD_COUNTERS;
+    }
+    uint8_t changedRows[ROW_MASK_BYTES] = {};
+    bool anyRow = false;
+    for (int row = 0; row < Snapshot::ROWS; ++row) {
+        if (current.rows[row] != base.rows[row]) {
+            changedRows[row / 8] |= static_cast<uint8_t>(1u << (row % 8));
+            anyRow = true;
+        }
+    }
+    if (anyRow) {
+        fields |= FIELD_ROWS;
+    }
+
+    writer.byte(fields);
+    if (fields & FIELD_PIECE) {
+        writer.byte(static_cast<uint8_t>(static_cast<uint8_t>(current.pieceType) | (current.rotation << 3)));
+        writer.byte(static_cast<uint8_t>(current.x));
+        writer.byte(static_cast<uint8_t>(current.y));
+    }
+    if (fields & FIELD_FLAGS) {
+        writer.byte(static_cast<uint8_t>((current.gameOver ? 1 : 0) | (current.paused ? 2 : 0)));
+    }
+    if (fields & FIELD_SCORE) {
+        writer.varint(static_cast<uint32_t>(current.score));
+    }
+    if (fields & FIELD_COUNTERS) {
+        writer.varint(current.piecesPlaced);
+        writer.varint(current.linesCleared);
+    }
+    if (fields & FIELD_ROWS) {
+        for (uint8_t mask : changedRows) {
+            writer.byte(mask);
+        }
+        for (int row = 0; row < Snapshot::ROWS; ++row) {
+            if (changedRows[row / 8] & (1u << (row % 8))) {
+                writer.byte(static_cast<uint8_t>(current.rows[row]));
+                writer.byte(static_cast<uint8_t>(current.rows[row] >> 8));
+            }
+        }
+    }
+}
+
+bool readFields(Reader& reader, Snapshot& snapshot) {
+    uint8_t fields = reader.byte();
+    if (fields & ~ALL_FIELDS) {
+        return false;
+    }
+    if (fields & FIELD_PIECE) {
+        uint8_t packed = reader.byte();
+        if ((packed & 7) >= TETROMINO_TYPE_COUNT || (packed >> 3) >= ROTATION_COUNT) {
+            return false;
+        }
+        snapshot.pieceType = static_cast<TetrominoType>(packed & 7);
+        snapshot.rotation = static_cast<uint8_t>(packed >> 3);
+        snapshot.x = static_cast<int8_t>(reader.byte());
+        snapshot.y = static_cast<int8_t>(reader.byte());
+    }
+    if (fields & FIELD_FLAGS) {
+        uint8_t flags = reader.byte();
+        snapshot.gameOver = (flags & 1) != 0;
+        snapshot.paused = (flags & 2) != 0;
+    }
+    if (fields & FIELD_SCORE) {
+        snapshot.score = static_cast<int32_t>(reader.varint());
+    }
+    if (fields & FIELD_COUNTERS) {
+        snapshot.piecesPlaced = reader.varint();
+        snapshot.linesCleared = reader.varint();
+    }
+    if (fields & FIELD_ROWS) {
+        uint8_t changedRows[ROW_MASK_BYTES];
+        for (int i = 0; i < ROW_MASK_BYTES; ++i) {
+            changedRows[i] = reader.byte();
+        }
+        for (int row = 0; row < Snapshot::ROWS; ++row) {
+            if (changedRows[row / 8] & (1u << (row % 8))) {
+                uint16_t low = reader.byte();
+                uint16_t high = reader.byte();
+                snapshot.rows[row] = static_cast<uint16_t>((low | (high << 8)) & Snapshot::FULL_ROW);
+            }
+        }
+    }
+    return reader.done();
+}
+
+}
+
+Snapshot Snapshot::capture(const GameState& state, uint32_t tick) {
+    const Tetromino& piece = state.getCurrentTetromino();
+
+    Snapshot snapshot;
+    snapshot.tick = tick;
+    snapshot.score = state.getScore();
+    snapshot.piecesPlaced = static_cast<uint32_t>(state.getPiecesPlaced());
+    snapshot.linesCleared = static_cast<uint32_t>(state.getLinesCleared());
+    snapshot.gameOver = state.isGameOver();
+    snapshot.paused = state.isPaused();
+    snapshot.pieceType = piece.getType();
+    snapshot.rotation = static_cast<uint8_t>(piece.getRotation());
+    snapshot.x = static_cast<int8_t>(piece.getPosition().x);
+    snapshot.y = static_cast<int8_t>(piece.getPosition().y);
+    for (int row = 0; row < ROWS; ++row) {
+        snapshot.rows[row] = static_cast<uint16_t>(state.getBoard().getRowMask(row));
+    }
+    return snapshot;
+}
+
+bool Snapshot::sameContents(const Snapshot& other) const {
+    return score == other.score && piecesPlaced == other.piecesPlaced && linesCleared == other.linesCleared &&
+           gameOver == other.gameOver && paused == other.paused && pieceType == other.pieceType &&
+           rotation == other.rotation && x == other.x && y == other.y &&
+           std::memcmp(rows, other.rows, sizeof(rows)) == 0;
+}
+
+void Snapshot::applyTo(GameState& state) const {
+    Board board;
+    for (int row = 0; row < ROWS; ++row) {
+        board.setRowMask(row, rows[row]);
+    }
+    Tetromino piece(pieceType, Position(x, y), rotation);
+    state.restore(board, piece, score, static_cast<int>(piecesPlaced), static_cast<int>(linesCleared),
+                  gameOver, paused);
+}
+
+SnapshotEncoder::SnapshotEncoder()
+    : generation(0) {
+}
+
+bool SnapshotEncoder::capture(const GameState& state, uint32_t tick) {
+    return capture(Snapshot::capture(state, tick));
+}
+
+bool SnapshotEncoder::capture(const Snapshot& snapshot) {
+    if (generation != 0 && snapshot.sameContents(getCurrent())) {
+        return false;
+    }
+    generation++;
+    Snapshot& slot = history[generation % HISTORY];
+    slot = snapshot;
+    slot.generation = generation;
+    return true;
+}
+
+void SnapshotEncoder::encode(std::vector<uint8_t>& out, uint8_t slot, uint32_t baseGeneration) const {
+    if (generation == 0 || baseGeneration == generation) {
+        return;
+    }
+
+    bool baseKnown = baseGeneration != 0 && baseGeneration < generation &&
+                     generation - baseGeneration < HISTORY &&
+                     history[baseGeneration % HISTORY].generation == baseGeneration;
+    if (!baseKnown || generation % KEYFRAME_INTERVAL == 0) {
+        encodeKeyframe(out, slot);
+        return;
+    }
+
+    const Snapshot& current = getCurrent();
+    uint8_t payload[MAX_PAYLOAD];
+    Writer writer(payload);
+    writer.byte(slot);
+    writer.varint(generation);
+    writer.varint(generation - baseGeneration);
+    writer.varint(current.tick);
+    writeFields(writer, current, history[baseGeneration % HISTORY], 0);
+    encodeFrame(out, MessageType::Delta, payload, writer.size);
+}
+
+void SnapshotEncoder::encodeKeyframe(std::vector<uint8_t>& out, uint8_t slot) const {
+    if (generation == 0) {
+        return;
+    }
+
+    const Snapshot& current = getCurrent();
+    uint8_t payload[MAX_PAYLOAD];
+    Writer writer(payload);
+    writer.byte(slot);
+    writer.varint(generation);
+    writer.varint(current.tick);
+    writeFields(writer, current, EMPTY_SNAPSHOT, ALL_FIELDS & ~FIELD_ROWS);
+    encodeFrame(out, MessageType::Keyframe, payload, writer.size);
+}
+
+SnapshotDecoder::SnapshotDecoder()
+    : generation(0) {
+}
+
+bool SnapshotDecoder::apply(MessageType type, const uint8_t* payload, std::size_t size) {
+    Reader reader(payload, size);
+    reader.byte();
+    uint32_t newGeneration = reader.varint();
+
+    Snapshot snapshot;
+    if (type == MessageType::Delta) {
+        uint32_t distance = reader.varint();
+        uint32_t base = newGeneration - distance;
+        const Snapshot& baseSnapshot = history[base % SnapshotEncoder::HISTORY];
+        if (reader.failed || distance == 0 || base == 0 || baseSnapshot.generation != base) {
+            return false;
+        }
+        snapshot = baseSnapshot;
+    } else if (type != MessageType::Keyframe) {
+        return false;
+    }
+
+    snapshot.tick = reader.varint();
+    if (newGeneration == 0 || !readFields(reader, snapshot)) {
+        return false;
+    }
+
+    snapshot.generation = newGeneration;
+    history[newGeneration % SnapshotEncoder::HISTORY] = snapshot;
+    generation = newGeneration;
+    return true;
+}
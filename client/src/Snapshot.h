@@ -0,0 +1,92 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Board.h"
+#include "GameState.h"
+#include "Protocol.h"
+#include "TetrominoShapes.h"
+
+// Everything a remote client or spectator needs to draw one board. Networked games always
+// use the default board size.
+struct Snapshot {
+    static constexpr int ROWS = Board::DEFAULT_ROWS;
+    static constexpr int COLS = Board::DEFAULT_COLS;
+    static constexpr uint16_t FULL_ROW = (1u << COLS) - 1;
+
+    uint32_t generation = 0;
+    uint32_t tick = 0;
+    int32_t score = 0;
+    uint32_t piecesPlaced = 0;
+    uint32_t linesCleared = 0;
+    bool gameOver = false;
+    bool paused = false;
+    TetrominoType pieceType = TetrominoType::I;
+    uint8_t rotation = 0;
+    int8_t x = 0;
+    int8_t y = 0;
+    uint16_t rows[ROWS] = {};
+
+    static Snapshot capture(const GameState& state, uint32_t tick);
+    // Compares what is visible; generation and tick are ignored.
+    bool sameContents(const Snapshot& other) const;
+    void applyTo(GameState& state) const;
+};
+
+// Server side of one board. Every capture that changes the board starts a new
+// generation; encode() sends a client only what changed since the generation it last
+// acknowledged, from a short history of past snapshots.
+//
+// Keyframe and Delta payloads (varints are LEB128):
+//   uint8 slot, varint generation, [Delta only: varint generation - base], varint tick,
+//   uint8 fields, then for each bit set in fields:
+//     PIECE     uint8 type | rotation << 3, int8 x, int8 y
+//     FLAGS     uint8 gameOver | paused << 1
+//     SCORE     varint score
+//     COUNTERS  varint piecesPlaced, varint linesCleared
+//     ROWS      one bit per row (ROW_MASK_BYTES), then uint16 for every row whose bit is set
+// A keyframe is a delta against an empty board with every field present.
+class SnapshotEncoder {
+public:
+    static constexpr int HISTORY = 32;
+    // Every KEYFRAME_INTERVAL-th generation goes out as a keyframe to everyone, so a
+    // client that lost track recovers without asking.
+    static constexpr uint32_t KEYFRAME_INTERVAL = 64;
+
+    SnapshotEncoder();
+
+    // Returns true when the board changed, i.e. a new generation was started.
+    bool capture(const GameState& state, uint32_t tick);
+    bool capture(const Snapshot& snapshot);
+    uint32_t getGeneration() const { return generation; }
+    const Snapshot& getCurrent() const { return history[generation % HISTORY]; }
+
+    // Brings a client holding `baseGeneration` (0 for none) up to the current generation.
+    void encode(std::vector<uint8_t>& out, uint8_t slot, uint32_t baseGeneration) const;
+    void encodeKeyframe(std::vector<uint8_t>& out, uint8_t slot) const;
+
+private:
+    Snapshot history[HISTORY];
+    uint32_t generation;
+};
+
+// Client side of one board: rebuilds snapshots from keyframes and deltas.
+class SnapshotDecoder {
+public:
+    SnapshotDecoder();
+
+    // Applies a Keyframe or Delta payload. Returns false when it is malformed or its base
+    // generation is no longer known; the next keyframe resynchronizes.
+    bool apply(MessageType type, const uint8_t* payload, std::size_t size);
+    bool hasSnapshot() const { return generation != 0; }
+    uint32_t getGeneration() const { return generation; }
+    const Snapshot& getCurrent() const { return history[generation % SnapshotEncoder::HISTORY]; }
+
+private:
+    Snapshot history[SnapshotEncoder::HISTORY];
+    uint32_t generation;
+};
+
+#endif
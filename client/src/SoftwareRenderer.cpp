@@ -0,0 +1,125 @@
+#include "SoftwareRenderer.h"
+
+namespace {
+
+const Rgba BACKGROUND = {0, 0, 0, 255};
+const Rgba EMPTY_FILL = {50, 50, 50, 255};
+const Rgba EMPTY_OUTLINE = {255, 255, 255, 255};
+const Rgba LOCKED_FILL = {169, 169, 169, 255};
+const Rgba LOCKED_OUTLINE = {200, 200, 200, 255};
+const Rgba PIECE_OUTLINE = {255, 255, 255, 255};
+const Rgba PANEL_COLOR = {30, 30, 30, 255};
+const Rgba BUTTON_COLOR = {100, 100, 100, 255};
+const Rgba TEXT_COLOR = {255, 255, 255, 255};
+const Rgba OVERLAY_COLOR = {0, 0, 0, 150};
+const Rgba GAME_OVER_COLOR = {255, 0, 0, 255};
+const Rgba FINAL_SCORE_COLOR = {60, 179, 113, 255};
+
+const int TEXT_SCALE = 3;
+const int TITLE_SCALE = 8;
+const int SUBTITLE_SCALE = 4;
+
+}
+
+SoftwareRenderer::SoftwareRenderer()
+    : background(WINDOW_WIDTH, WINDOW_HEIGHT),
+      frame(WINDOW_WIDTH, WINDOW_HEIGHT),
+      backgroundReady(false) {
+}
+
+Rgba SoftwareRenderer::getTetrominoColor(TetrominoType type) {
+    switch (type) {
+        case TetrominoType::I: return {0, 255, 255, 255};
+        case TetrominoType::O: return {255, 255, 0, 255};
+        case TetrominoType::T: return {128, 0, 128, 255};
+        case TetrominoType::S: return {0, 255, 0, 255};
+        case TetrominoType::Z: return {255, 0, 0, 255};
+        case TetrominoType::J: return {0, 0, 255, 255};
+        case TetrominoType::L: return {255, 165, 0, 255};
+    }
+    return {255, 255, 255, 255};
+}
+
+void SoftwareRenderer::drawCell(int col, int row, Rgba fill, Rgba outline) {
+    const int cell = layout.cellSize;
+    const int x = layout.x + col * cell;
+    const int y = layout.y + row * cell;
+    frame.fillRect(x, y, cell, cell, fill);
+    frame.drawRect(x, y, cell, cell, outline);
+}
+
+void SoftwareRenderer::drawCentredText(const std::string& text, int x, int y, int width, int scale, Rgba color) {
+    frame.drawText(text, x + (width - Framebuffer::measureText(text, scale)) / 2, y, scale, color);
+}
+
+void SoftwareRenderer::drawBackground() {
+    frame.clear(BACKGROUND);
+    for (int row = 0; row < layout.visibleRows; ++row) {
+        for (int col = 0; col < layout.cols; ++col) {
+            drawCell(col, row, EMPTY_FILL, EMPTY_OUTLINE);
+        }
+    }
+
+    frame.fillRect(SCORE_AREA_X, 0, SCORE_AREA_WIDTH, WINDOW_HEIGHT, PANEL_COLOR);
+    const int buttonX = SCORE_AREA_X + (SCORE_AREA_WIDTH - 140) / 2;
+    const int buttonY = SCORE_Y + 100;
+    frame.fillRect(buttonX, buttonY, 150, 50, BUTTON_COLOR);
+    drawCentredText("Pause: P/E", buttonX, buttonY + (50 - Framebuffer::GLYPH_HEIGHT * TEXT_SCALE) / 2, 150,
+                    TEXT_SCALE, TEXT_COLOR);
+    background.copyFrom(frame);
+}
+
+void SoftwareRenderer::drawGameOver(int score) {
+    frame.blendRect(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, OVERLAY_COLOR);
+    const int titleHeight = Framebuffer::GLYPH_HEIGHT * TITLE_SCALE;
+    const int subtitleHeight = Framebuffer::GLYPH_HEIGHT * SUBTITLE_SCALE;
+    drawCentredText("Game Over", 0, (WINDOW_HEIGHT - titleHeight) / 3, WINDOW_WIDTH, TITLE_SCALE, GAME_OVER_COLOR);
+    drawCentredText("Your score is: " + std::to_string(score), 0, (WINDOW_HEIGHT - subtitleHeight) / 2,
+                    WINDOW_WIDTH, SUBTITLE_SCALE, FINAL_SCORE_COLOR);
+}
+
+const Framebuffer& SoftwareRenderer::draw(const GameState& state) {
+    const Board& board = state.getBoard();
+    PlayfieldLayout next = PlayfieldLayout::of(board);
+    if (!backgroundReady || next != layout) {
+        layout = next;
+        drawBackground();
+        backgroundReady = true;
+    } else {
+        frame.copyFrom(background);
+    }
+
+    const Tetromino& tetromino = state.getCurrentTetromino();
+    const auto& shape = tetromino.getShape();
+    const auto& pos = tetromino.getPosition();
+    int firstRow = layout.firstVisibleRow(board, tetromino);
+
+    for (int row = 0; row < layout.visibleRows; ++row) {
+        uint64_t mask = board.getRowMask(firstRow + row);
+        for (int col = 0; mask; ++col, mask >>= 1) {
+            if (mask & 1) {
+                drawCell(col, row, LOCKED_FILL, LOCKED_OUTLINE);
+            }
+        }
+    }
+
+    const Rgba pieceColor = getTetrominoColor(tetromino.getType());
+    for (int row = 0; row < shape.height; ++row) {
+        int visibleRow = pos.y + row - firstRow;
+        if (visibleRow < 0 || visibleRow >= layout.visibleRows) {
+            continue;
+        }
+        for (int col = 0; col < shape.width; ++col) {
+            if (shape.isFilled(row, col)) {
+                drawCell(pos.x + col, visibleRow, pieceColor, PIECE_OUTLINE);
+            }
+        }
+    }
+
+    drawCentredText("Score: " + std::to_string(state.getScore()), SCORE_AREA_X, SCORE_Y, SCORE_AREA_WIDTH,
+                    TEXT_SCALE, TEXT_COLOR);
+    if (state.isGameOver()) {
+        drawGameOver(state.getScore());
+    }
+    return frame;
+}
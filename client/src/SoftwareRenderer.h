@@ -0,0 +1,35 @@
+#ifndef SOFTWARE_RENDERER_H
+#define SOFTWARE_RENDERER_H
+
+#include "Framebuffer.h"
+#include "GameState.h"
+#include "Playfield.h"
+
+// Draws the same scene as Game::render (grid, locked cells, falling piece and score panel)
+// into a Framebuffer, with no window, GPU or SDL. Used to record frames from headless
+// runs. As in BoardRenderer the grid and the panel are drawn once into a cached background
+// that starts every frame. Text uses Framebuffer's bitmap font instead of TTF, so frames
+// match the client's layout and colors but not its lettering. The game over screen is
+// laid over the final board instead of a blank one, so a recording ends on the position.
+class SoftwareRenderer {
+public:
+    SoftwareRenderer();
+
+    const Framebuffer& draw(const GameState& state);
+    const Framebuffer& getFrame() const { return frame; }
+
+    static Rgba getTetrominoColor(TetrominoType type);
+
+private:
+    Framebuffer background;
+    Framebuffer frame;
+    PlayfieldLayout layout;
+    bool backgroundReady;
+
+    void drawBackground();
+    void drawCell(int col, int row, Rgba fill, Rgba outline);
+    void drawGameOver(int score);
+    void drawCentredText(const std::string& text, int x, int y, int width, int scale, Rgba color);
+};
+
+#endif
@@ -1,11 +1,10 @@
+#include <type_traits>
 #include "Tetromino.h"
 
-Tetromino::Tetromino(TetrominoType type, const std::vector<std::vector<int>>& shape, const Position& pos)
-    : type(type), shape(shape), position(pos) {
-}
+static_assert(std::is_trivially_copyable<Tetromino>::value, "Tetromino must stay cheap to copy");
 
-const std::vector<std::vector<int>>& Tetromino::getShape() const {
-    return shape;
+Tetromino::Tetromino(TetrominoType type, const Position& pos, int rotation)
+    : position(pos), type(type), rotation(rotation & (ROTATION_COUNT - 1)) {
 }
 
 const Position& Tetromino::getPosition() const {
@@ -22,11 +21,9 @@ void Tetromino::move(int dx, int dy) {
 }
 
 void Tetromino::rotate() {
-    std::vector<std::vector<int>> rotated(shape[0].size(), std::vector<int>(shape.size()));
-    for (size_t row = 0; row < shape.size(); ++row) {
-        for (size_t col = 0; col < shape[row].size(); ++col) {
-            rotated[col][shape.size() - 1 - row] = shape[row][col];
-        }
-    }
-    shape = rotated;
-};
\ No newline at end of file
+    rotation = (rotation + 1) & (ROTATION_COUNT - 1);
+}
+
+void Tetromino::rotateBack() {
+    rotation = (rotation + ROTATION_COUNT - 1) & (ROTATION_COUNT - 1);
+}
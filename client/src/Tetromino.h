@@ -1,29 +1,36 @@
 #ifndef TETROMINO_H
 #define TETROMINO_H
 
-#include <vector>
+#include <cstdint>
 #include "Position.h"
+#include "TetrominoShapes.h"
 
 enum class TetrominoType {
     I, O, T, S, Z, J, L
 };
 
+// A piece is just a type, an orientation and a position; the cells come from SHAPE_TABLE.
 class Tetromino {
 private:
-    std::vector<std::vector<int>> shape;
     Position position;
     TetrominoType type;
+    int rotation;
 
 public:
-    Tetromino(TetrominoType type, const std::vector<std::vector<int>>& shape, const Position& pos);
+    Tetromino(TetrominoType type, const Position& pos, int rotation = 0);
 
-    const std::vector<std::vector<int>>& getShape() const;
+    const ShapeData& getShape() const { return SHAPE_TABLE.shapes[static_cast<int>(type)][rotation]; }
     const Position& getPosition() const;
     TetrominoType getType() const;
+    int getRotation() const { return rotation; }
+    uint16_t getRowMask(int row) const { return getShape().rowMasks[row]; }
+    int getWidth() const { return getShape().width; }
+    int getHeight() const { return getShape().height; }
 
     void move(int dx, int dy);
 
     void rotate();
+    void rotateBack();
 };
 
 #endif
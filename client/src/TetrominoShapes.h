@@ -0,0 +1,87 @@
+#ifndef TETROMINO_SHAPES_H
+#define TETROMINO_SHAPES_H
+
+#include <cstdint>
+
+constexpr int TETROMINO_TYPE_COUNT = 7;
+constexpr int ROTATION_COUNT = 4;
+constexpr int MAX_SHAPE_SIZE = 4;
+
+// One orientation of a piece: a tight bounding box plus one occupancy mask per row
+// (bit `col` is set when that cell is filled).
+struct ShapeData {
+    uint16_t rowMasks[MAX_SHAPE_SIZE] = {};
+    int width = 0;
+    int height = 0;
+
+    constexpr bool isFilled(int row, int col) const {
+        return (rowMasks[row] >> col) & 1;
+    }
+};
+
+struct ShapeTable {
+    ShapeData shapes[TETROMINO_TYPE_COUNT][ROTATION_COUNT] = {};
+};
+
+// Builds a shape from rows drawn with '#' for filled cells.
+constexpr ShapeData makeShape(const char* top, const char* bottom = nullptr) {
+    ShapeData shape;
+    const char* rows[] = {top, bottom};
+    for (const char* row : rows) {
+        if (!row) {
+            break;
+        }
+        int col = 0;
+        for (; row[col]; ++col) {
+            if (row[col] == '#') {
+                shape.rowMasks[shape.height] |= static_cast<uint16_t>(1u << col);
+            }
+        }
+        shape.width = col;
+        ++shape.height;
+    }
+    return shape;
+}
+
+// Same clockwise turn the old Tetromino::rotate() did: rotated[col][height - 1 - row] = shape[row][col].
+constexpr ShapeData rotateClockwise(const ShapeData& shape) {
+    ShapeData rotated;
+    rotated.width = shape.height;
+    rotated.height = shape.width;
+    for (int row = 0; row < shape.height; ++row) {
+        for (int col = 0; col < shape.width; ++col) {
+            if (shape.isFilled(row, col)) {
+                rotated.rowMasks[col] |= static_cast<uint16_t>(1u << (shape.height - 1 - row));
+            }
+        }
+    }
+    return rotated;
+}
+
+constexpr ShapeTable buildShapeTable() {
+    const ShapeData spawnShapes[TETROMINO_TYPE_COUNT] = {
+        makeShape("####"),          // I shape
+        makeShape("##",  "##"),     // O shape
+        makeShape(".#.", "###"),    // T shape
+        makeShape(".##", "##."),    // S shape
+        makeShape("##.", ".##"),    // Z shape
+        makeShape("#..", "###"),    // J shape
+        makeShape("..#", "###")     // L shape
+    };
+
+    ShapeTable table;
+    for (int type = 0; type < TETROMINO_TYPE_COUNT; ++type) {
+        table.shapes[type][0] = spawnShapes[type];
+        for (int rotation = 1; rotation < ROTATION_COUNT; ++rotation) {
+            table.shapes[type][rotation] = rotateClockwise(table.shapes[type][rotation - 1]);
+        }
+    }
+    return table;
+}
+
+inline constexpr ShapeTable SHAPE_TABLE = buildShapeTable();
+
+static_assert(SHAPE_TABLE.shapes[0][1].width == 1 && SHAPE_TABLE.shapes[0][1].height == 4,
+              "I shape should stand upright after one rotation");
+
+#endif
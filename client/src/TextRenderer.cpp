@@ -0,0 +1,221 @@
+#include <iostream>
+#include <mutex>
+#include "TextRenderer.h"
+#include "Constants.h"
+
+namespace {
+
+std::mutex fontMutex;
+std::map<int, TTF_Font*> fonts;
+
+const int ATLAS_WIDTH = 512;
+
+}
+
+TextRenderer::TextRenderer(SDL_Renderer* renderer)
+    : renderer(renderer) {
+}
+
+TextRenderer::~TextRenderer() {
+    for (auto& entry : staticTexts) {
+        SDL_DestroyTexture(entry.second.texture);
+    }
+    for (auto& entry : valueTexts) {
+        SDL_DestroyTexture(entry.second.text.texture);
+    }
+    for (auto& entry : atlases) {
+        SDL_DestroyTexture(entry.second.texture);
+    }
+}
+
+TTF_Font* TextRenderer::getFont(int size) {
+    std::lock_guard<std::mutex> lock(fontMutex);
+    auto it = fonts.find(size);
+    if (it != fonts.end()) {
+        return it->second;
+    }
+
+    TTF_Font* font = TTF_OpenFont(FONT_PATH, size);
+    if (!font) {
+        std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
+        return nullptr;
+    }
+    fonts[size] = font;
+    return font;
+}
+
+void TextRenderer::closeFonts() {
+    std::lock_guard<std::mutex> lock(fontMutex);
+    for (auto& entry : fonts) {
+        TTF_CloseFont(entry.second);
+    }
+    fonts.clear();
+}
+
+uint32_t TextRenderer::packColor(SDL_Color color) {
+    return (uint32_t(color.r) << 24) | (uint32_t(color.g) << 16) | (uint32_t(color.b) << 8) | color.a;
+}
+
+TextTexture TextRenderer::rasterize(const std::string& text, int size, SDL_Color color) {
+    TextTexture result;
+    TTF_Font* font = getFont(size);
+    if (!font) {
+        return result;
+    }
+
+    SDL_Surface* surface = TTF_RenderText_Blended(font, text.c_str(), color);
+    if (!surface) {
+        std::cerr << "Failed to create text surface! SDL_ttf Error: " << TTF_GetError() << std::endl;
+        return result;
+    }
+
+    result.texture = SDL_CreateTextureFromSurface(renderer, surface);
+    if (!result.texture) {
+        std::cerr << "Failed to create text texture! SDL Error: " << SDL_GetError() << std::endl;
+    } else {
+        result.w = surface->w;
+        result.h = surface->h;
+    }
+    SDL_FreeSurface(surface);
+    return result;
+}
+
+const TextTexture& TextRenderer::getStatic(const char* text, int size, SDL_Color color) {
+    TextKey key(text, size, packColor(color));
+    auto it = staticTexts.find(key);
+    if (it == staticTexts.end()) {
+        it = staticTexts.emplace(key, rasterize(text, size, color)).first;
+    }
+    return it->second;
+}
+
+const TextTexture& TextRenderer::getValue(const char* label, int value, int size, SDL_Color color) {
+    TextKey key(label, size, packColor(color));
+    auto it = valueTexts.find(key);
+    if (it == valueTexts.end()) {
+        ValueText entry;
+        entry.value = value;
+        entry.text = rasterize(std::string(label) + std::to_string(value), size, color);
+        return valueTexts.emplace(key, entry).first->second.text;
+    }
+
+    ValueText& entry = it->second;
+    if (entry.value != value || !entry.text.texture) {
+        SDL_DestroyTexture(entry.text.texture);
+        entry.value = value;
+        entry.text = rasterize(std::string(label) + std::to_string(value), size, color);
+    }
+    return entry.text;
+}
+
+void TextRenderer::draw(const TextTexture& text, int x, int y) {
+    if (!text.texture) {
+        return;
+    }
+    SDL_Rect dstRect = {x, y, text.w, text.h};
+    SDL_RenderCopy(renderer, text.texture, nullptr, &dstRect);
+}
+
+// Rasterizes the printable ASCII range once into a single texture. Glyphs are white
+// so any color can be applied with SDL_SetTextureColorMod.
+const TextRenderer::Atlas* TextRenderer::getAtlas(int size) {
+    auto it = atlases.find(size);
+    if (it != atlases.end()) {
+        return it->second.texture ? &it->second : nullptr;
+    }
+
+    Atlas& atlas = atlases[size];
+    TTF_Font* font = getFont(size);
+    if (!font) {
+        return nullptr;
+    }
+
+    const SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* glyphSurfaces[LAST_GLYPH - FIRST_GLYPH + 1] = {};
+
+    atlas.lineHeight = TTF_FontHeight(font);
+    int penX = 0;
+    int penY = 0;
+    for (int ch = FIRST_GLYPH; ch <= LAST_GLYPH; ++ch) {
+        Glyph& glyph = atlas.glyphs[ch - FIRST_GLYPH];
+        TTF_GlyphMetrics(font, static_cast<Uint16>(ch), nullptr, nullptr, nullptr, nullptr, &glyph.advance);
+
+        SDL_Surface* surface = TTF_RenderGlyph_Blended(font, static_cast<Uint16>(ch), white);
+        glyphSurfaces[ch - FIRST_GLYPH] = surface;
+        if (!surface) {
+            continue;
+        }
+
+        if (penX + surface->w > ATLAS_WIDTH) {
+            penX = 0;
+            penY += atlas.lineHeight;
+        }
+        glyph.source = {penX, penY, surface->w, surface->h};
+        penX += surface->w;
+    }
+
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_WIDTH, penY + atlas.lineHeight, 32, SDL_PIXELFORMAT_RGBA32);
+    for (int i = 0; i <= LAST_GLYPH - FIRST_GLYPH; ++i) {
+        SDL_Surface* surface = glyphSurfaces[i];
+        if (!surface) {
+            continue;
+        }
+        if (sheet) {
+            SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+            SDL_Rect target = atlas.glyphs[i].source;
+            SDL_BlitSurface(surface, nullptr, sheet, &target);
+        }
+        SDL_FreeSurface(surface);
+    }
+
+    if (!sheet) {
+        std::cerr << "Failed to create glyph atlas! SDL Error: " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+
+    atlas.texture = SDL_CreateTextureFromSurface(renderer, sheet);
+    SDL_FreeSurface(sheet);
+    if (!atlas.texture) {
+        std::cerr << "Failed to create glyph atlas texture! SDL Error: " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+    SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
+    return &atlas;
+}
+
+void TextRenderer::drawText(const std::string& text, int size, int x, int y, SDL_Color color) {
+    const Atlas* atlas = getAtlas(size);
+    if (!atlas) {
+        return;
+    }
+
+    SDL_SetTextureColorMod(atlas->texture, color.r, color.g, color.b);
+    int penX = x;
+    for (char ch : text) {
+        int index = static_cast<unsigned char>(ch) - FIRST_GLYPH;
+        if (index < 0 || index > LAST_GLYPH - FIRST_GLYPH) {
+            continue;
+        }
+        const Glyph& glyph = atlas->glyphs[index];
+        SDL_Rect dstRect = {penX, y, glyph.source.w, glyph.source.h};
+        SDL_RenderCopy(renderer, atlas->texture, &glyph.source, &dstRect);
+        penX += glyph.advance;
+    }
+}
+
+SDL_Point TextRenderer::measureText(const std::string& text, int size) {
+    SDL_Point extent = {0, 0};
+    const Atlas* atlas = getAtlas(size);
+    if (!atlas) {
+        return extent;
+    }
+
+    extent.y = atlas->lineHeight;
+    for (char ch : text) {
+        int index = static_cast<unsigned char>(ch) - FIRST_GLYPH;
+        if (index >= 0 && index <= LAST_GLYPH - FIRST_GLYPH) {
+            extent.x += atlas->glyphs[index].advance;
+        }
+    }
+    return extent;
+}
@@ -0,0 +1,75 @@
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+// A rasterized string ready to be copied to the screen.
+struct TextTexture {
+    SDL_Texture* texture = nullptr;
+    int w = 0;
+    int h = 0;
+};
+
+// Text drawing for one SDL_Renderer. Fonts are opened once per size and shared by every
+// TextRenderer; textures belong to this renderer and are created lazily:
+//  - getStatic() caches whole strings that never change ("Pause: P/E"),
+//  - getValue() caches "label + number" lines and re-rasterizes only when the number changes,
+//  - drawText() draws arbitrary text from a per-size glyph atlas without touching SDL_ttf.
+class TextRenderer {
+public:
+    explicit TextRenderer(SDL_Renderer* renderer);
+    ~TextRenderer();
+    TextRenderer(const TextRenderer&) = delete;
+    TextRenderer& operator=(const TextRenderer&) = delete;
+
+    static TTF_Font* getFont(int size);
+    // Closes every font opened by getFont(); call before the last TTF_Quit().
+    static void closeFonts();
+
+    // Both caches are keyed on the string's address, so a cache hit never allocates; pass
+    // string literals (or other text that outlives the renderer and never changes).
+    const TextTexture& getStatic(const char* text, int size, SDL_Color color);
+    const TextTexture& getValue(const char* label, int value, int size, SDL_Color color);
+    void draw(const TextTexture& text, int x, int y);
+
+    void drawText(const std::string& text, int size, int x, int y, SDL_Color color);
+    SDL_Point measureText(const std::string& text, int size);
+
+private:
+    static constexpr int FIRST_GLYPH = 32;
+    static constexpr int LAST_GLYPH = 126;
+
+    struct Glyph {
+        SDL_Rect source = {0, 0, 0, 0};
+        int advance = 0;
+    };
+
+    struct Atlas {
+        SDL_Texture* texture = nullptr;
+        Glyph glyphs[LAST_GLYPH - FIRST_GLYPH + 1];
+        int lineHeight = 0;
+    };
+
+    struct ValueText {
+        int value = 0;
+        TextTexture text;
+    };
+
+    using TextKey = std::tuple<const char*, int, uint32_t>;
+
+    SDL_Renderer* renderer;
+    std::map<TextKey, TextTexture> staticTexts;
+    std::map<TextKey, ValueText> valueTexts;
+    std::map<int, Atlas> atlases;
+
+    static uint32_t packColor(SDL_Color color);
+    TextTexture rasterize(const std::string& text, int size, SDL_Color color);
+    const Atlas* getAtlas(int size);
+};
+
+#endif
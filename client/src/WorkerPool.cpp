@@ -0,0 +1,140 @@
+#include <algorithm>
+#include "WorkerPool.h"
+#include "Profiler.h"
+
+WorkerPool::WorkerPool(int threadCount)
+    : running(true),
+      sequence(0),
+      nextQueue(0),
+      version(0) {
+    if (threadCount <= 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (int i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (int i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&WorkerPool::workerLoop, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    stop();
+}
+
+void WorkerPool::schedule(Task task, Clock::time_point deadline) {
+    Queue& queue = *queues[nextQueue++ % queues.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.entries.push({deadline, sequence++, std::move(task)});
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        ++version;
+    }
+    wakeUp.notify_one();
+}
+
+void WorkerPool::parallelFor(int count, const std::function<void(int)>& body) {
+    struct Job {
+        std::atomic<int> nextIndex{0};
+        std::atomic<int> finished{0};
+        std::mutex mutex;
+        std::condition_variable allDone;
+    };
+
+    auto job = std::make_shared<Job>();
+    auto work = [job, count, &body]() {
+        for (int i = job->nextIndex++; i < count; i = job->nextIndex++) {
+            body(i);
+            if (++job->finished == count) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->allDone.notify_all();
+            }
+        }
+    };
+
+    int helpers = std::min(getThreadCount(), count - 1);
+    for (int i = 0; i < helpers; ++i) {
+        // Helpers that start after everything is claimed return without touching `body`.
+        schedule([job, count, work]() {
+            if (job->nextIndex.load() < count) {
+                work();
+            }
+        });
+    }
+    work();
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->allDone.wait(lock, [&]() { return job->finished.load() >= count; });
+}
+
+void WorkerPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    wakeUp.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+bool WorkerPool::takeDueTask(Queue& queue, Clock::time_point now, Task& task, Clock::time_point& earliest) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.entries.empty()) {
+        return false;
+    }
+
+    const Entry& top = queue.entries.top();
+    if (top.deadline > now) {
+        earliest = std::min(earliest, top.deadline);
+        return false;
+    }
+
+    // priority_queue::top() is const; the entry is popped right after, so moving out is safe.
+    task = std::move(const_cast<Entry&>(top).task);
+    queue.entries.pop();
+    return true;
+}
+
+void WorkerPool::workerLoop(int index) {
+    PROFILE_THREAD("worker");
+    const int queueCount = static_cast<int>(queues.size());
+
+    while (running) {
+        uint64_t seenVersion;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            seenVersion = version;
+        }
+
+        Clock::time_point now = Clock::now();
+        Clock::time_point earliest = Clock::time_point::max();
+        Task task;
+
+        // Own queue first, then steal from the others.
+        bool found = false;
+        for (int offset = 0; offset < queueCount && !found; ++offset) {
+            found = takeDueTask(*queues[(index + offset) % queueCount], now, task, earliest);
+        }
+
+        if (found) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        auto woken = [&]() { return !running || version != seenVersion; };
+        if (earliest == Clock::time_point::max()) {
+            wakeUp.wait(lock, woken);
+        } else {
+            wakeUp.wait_until(lock, earliest, woken);
+        }
+    }
+}
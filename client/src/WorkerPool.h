@@ -0,0 +1,72 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads for deadline-driven work such as game ticks.
+// Every worker owns a queue ordered by deadline; a worker with nothing due in its own
+// queue steals a due task from its siblings, and otherwise sleeps until the earliest deadline.
+class WorkerPool {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Task = std::function<void()>;
+
+    // threadCount <= 0 means one worker per hardware thread.
+    explicit WorkerPool(int threadCount = 0);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int getThreadCount() const { return static_cast<int>(workers.size()); }
+
+    void schedule(Task task, Clock::time_point deadline);
+    void schedule(Task task) { schedule(std::move(task), Clock::now()); }
+    // Calls body(i) for every i in [0, count): the calling thread claims indices one at a
+    // time together with helper tasks on the pool. Each index is claimed exactly once and
+    // the caller only waits for claimed work, so this is safe to call from a worker too.
+    void parallelFor(int count, const std::function<void(int)>& body);
+    void stop();
+
+private:
+    struct Entry {
+        Clock::time_point deadline;
+        uint64_t sequence;
+        Task task;
+    };
+
+    struct EntryLater {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.deadline != b.deadline ? a.deadline > b.deadline : a.sequence > b.sequence;
+        }
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::priority_queue<Entry, std::vector<Entry>, EntryLater> entries;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> sequence;
+    std::atomic<unsigned> nextQueue;
+
+    // Bumped on every schedule() so a sleeping worker never misses newly queued work.
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    uint64_t version;
+
+    bool takeDueTask(Queue& queue, Clock::time_point now, Task& task, Clock::time_point& earliest);
+    void workerLoop(int index);
+};
+
+#endif
@@ -0,0 +1,605 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "Board.h"
+#include "Bot.h"
+#include "FixedBoard.h"
+#include "FrameWriter.h"
+#include "Framebuffer.h"
+#include "GameState.h"
+#include "Playfield.h"
+#include "Random.h"
+#include "Rollout.h"
+#include "Simulator.h"
+#include "Snapshot.h"
+#include "SoftwareRenderer.h"
+#include "Tetromino.h"
+
+#ifdef TETRIS_BENCH_RENDER
+#include <SDL2/SDL.h>
+#include "Constants.h"
+#include "Game.h"
+#endif
+
+// Microbenchmarks for the simulation hot paths.
+//
+//   tetris_bench [--samples N] [--out FILE]
+//   tetris_bench --audit
+//
+// Every benchmark is warmed up, then timed as N samples of a small batch of operations.
+// Median and p99 are per-operation latencies across samples; allocations are counted by
+// the global operator new below. Results are also written as JSON (bench_results.json).
+// Exits with 1 if steady-state play allocated (see auditAllocations); --audit runs only
+// that check, for CI.
+// Build with -DTETRIS_BENCH_RENDER and SDL2/SDL2_ttf to include Game::render into an
+// offscreen software renderer.
+
+namespace {
+
+std::atomic<long long> allocationCount(0);
+
+}
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps the compiler from discarding results that are never read.
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchResult {
+    std::string name;
+    int batchSize;
+    int samples;
+    double medianNs;
+    double p99Ns;
+    double minNs;
+    double allocsPerOp;
+};
+
+class BenchRunner {
+public:
+    explicit BenchRunner(int samples) : samples(samples) {}
+
+    // `setup` runs untimed before every sample, `op` runs `batchSize` times per sample.
+    template <typename Setup, typename Op>
+    void run(const std::string& name, int batchSize, Setup&& setup, Op&& op) {
+        const int warmupSamples = std::max(1, samples / 10);
+        std::vector<double> perOp;
+        perOp.reserve(samples);
+        long long allocations = 0;
+
+        for (int sample = 0; sample < warmupSamples + samples; ++sample) {
+            setup();
+            long long allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+            auto start = Clock::now();
+            for (int i = 0; i < batchSize; ++i) {
+                op(i);
+            }
+            auto elapsed = Clock::now() - start;
+            if (sample < warmupSamples) {
+                continue;
+            }
+            allocations += allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+            perOp.push_back(std::chrono::duration<double, std::nano>(elapsed).count() / batchSize);
+        }
+
+        std::sort(perOp.begin(), perOp.end());
+        BenchResult result;
+        result.name = name;
+        result.batchSize = batchSize;
+        result.samples = samples;
+        result.medianNs = perOp[perOp.size() / 2];
+        result.p99Ns = perOp[std::min(perOp.size() - 1, perOp.size() * 99 / 100)];
+        result.minNs = perOp.front();
+        result.allocsPerOp = static_cast<double>(allocations) / (static_cast<double>(samples) * batchSize);
+        results.push_back(result);
+
+        std::cout << std::left << std::setw(52) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << result.medianNs << std::setw(12) << result.p99Ns
+                  << std::setprecision(2) << std::setw(12) << result.allocsPerOp << std::endl;
+    }
+
+    template <typename Op>
+    void run(const std::string& name, int batchSize, Op&& op) {
+        run(name, batchSize, []() {}, std::forward<Op>(op));
+    }
+
+    bool writeJson(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) {
+            return false;
+        }
+        out << "{\n  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            out << "    {\"name\": \"" << r.name << "\", \"batch\": " << r.batchSize
+                << ", \"samples\": " << r.samples
+                << ", \"median_ns\": " << r.medianNs << ", \"p99_ns\": " << r.p99Ns
+                << ", \"min_ns\": " << r.minNs << ", \"allocs_per_op\": " << r.allocsPerOp << "}"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+private:
+    int samples;
+    std::vector<BenchResult> results;
+};
+
+// The bottom `fillPercent` of the rows hold garbage with one gap per row, so no line is full.
+Board makeBoard(int fillPercent, Xoshiro256& rng, BoardSize size = Board::DEFAULT_SIZE) {
+    Board board(size);
+    int filledRows = board.getRows() * fillPercent / 100;
+    for (int row = board.getRows() - filledRows; row < board.getRows(); ++row) {
+        uint64_t mask = rng.next() & board.getFullRow();
+        mask |= 1ull << rng.nextBelow(board.getCols());
+        mask &= ~(1ull << rng.nextBelow(board.getCols()));
+        board.setRowMask(row, mask);
+    }
+    // Nothing is full; this just leaves no rows marked for the next clearLines() to check.
+    board.clearLines();
+    return board;
+}
+
+std::vector<Tetromino> randomPieces(int count, Xoshiro256& rng) {
+    const int cols = Board::DEFAULT_COLS;
+    const int rows = Board::DEFAULT_ROWS;
+    std::vector<Tetromino> pieces;
+    for (int i = 0; i < count; ++i) {
+        Tetromino piece(static_cast<TetrominoType>(rng.nextBelow(TETROMINO_TYPE_COUNT)), Position(),
+                        static_cast<int>(rng.nextBelow(ROTATION_COUNT)));
+        piece.move(static_cast<int>(rng.nextBelow(cols - piece.getWidth() + 1)),
+                   static_cast<int>(rng.nextBelow(rows - piece.getHeight() + 1)));
+        pieces.push_back(piece);
+    }
+    return pieces;
+}
+
+// Collision, merge and clear on one board type; run for Board and each FixedBoard.
+template <typename BoardType>
+void benchBoardOps(BenchRunner& runner, const std::string& typeName, int fill, const Board& source,
+                   const std::vector<Tetromino>& pieces) {
+    const std::string suffix = " [fill " + std::to_string(fill) + "%]";
+    const int pieceCount = static_cast<int>(pieces.size());
+    BoardType board(source);
+
+    runner.run(typeName + "::checkCollision" + suffix, 1024, [&](int i) {
+        keep(board.checkCollision(pieces[i & (pieceCount - 1)], 0, 1));
+    });
+
+    // Pieces dropped to where they would rest, so merges never overlap.
+    std::vector<Tetromino> landed;
+    for (Tetromino piece : pieces) {
+        piece.move(0, -piece.getPosition().y);
+        if (board.checkCollision(piece, 0, 0)) {
+            continue;
+        }
+        while (!board.checkCollision(piece, 0, 1)) {
+            piece.move(0, 1);
+        }
+        landed.push_back(piece);
+    }
+    runner.run(typeName + "::mergeTetromino (incl. copy)" + suffix, 256, [&](int i) {
+        BoardType copy = board;
+        copy.mergeTetromino(landed[i % landed.size()]);
+        keep(copy);
+    });
+
+    // Two full rows inside the filled region (or at the bottom of an empty board).
+    const int rows = board.getRows();
+    BoardType clearable = board;
+    clearable.setRowMask(rows - 1, board.getFullRow());
+    clearable.setRowMask(rows - 1 - rows * fill / 200, board.getFullRow());
+    runner.run(typeName + "::clearLines (incl. copy)" + suffix, 256, [&](int) {
+        BoardType copy = clearable;
+        keep(copy.clearLines());
+    });
+}
+
+void benchBoard(BenchRunner& runner) {
+    Xoshiro256 rng(42);
+    const int pieceCount = 256;
+
+    for (int fill : {0, 25, 50, 75}) {
+        Board board = makeBoard(fill, rng);
+        std::vector<Tetromino> pieces = randomPieces(pieceCount, rng);
+        benchBoardOps<Board>(runner, "Board", fill, board, pieces);
+        benchBoardOps<StandardBoard>(runner, "StandardBoard", fill, board, pieces);
+    }
+
+    // Marathon boards: a line clear moves whichever side of the cleared row is shorter,
+    // so clearing near the bottom of a tall stack stays cheap. Each op fills one row and
+    // clears it again.
+    for (int clearAt : {100, 50}) {
+        Board tall = makeBoard(50, rng, {4000, 10});
+        const int row = (tall.getRows() - 1) * clearAt / 100;
+        const std::string name = "Board::clearLines [4000x10, row at " + std::to_string(clearAt) + "%]";
+        runner.run(name, 256, [&](int) {
+            tall.setRowMask(row, tall.getFullRow());
+            keep(tall.clearLines());
+        });
+    }
+}
+
+// One full placement search (both pieces, no time budget, no pool) and the evaluation
+// it runs on every leaf, on the runtime board and on its compile-time counterpart.
+void benchBot(BenchRunner& runner) {
+    Xoshiro256 rng(11);
+    Bot bot(BotWeights(), nullptr, std::chrono::hours(1));
+    Tetromino current(TetrominoType::T, Position(3, 0));
+    Tetromino next(TetrominoType::S, Position(3, 0));
+
+    for (int fill : {25, 50}) {
+        const std::string suffix = " [fill " + std::to_string(fill) + "%]";
+        Board board = makeBoard(fill, rng);
+        StandardBoard fixed(board);
+
+        runner.run("Bot::evaluate<Board>" + suffix, 256, [&](int) { keep(bot.evaluate(board, 0)); });
+        runner.run("Bot::evaluate<StandardBoard>" + suffix, 256, [&](int) { keep(bot.evaluate(fixed, 0)); });
+        runner.run("Bot::search<Board>" + suffix, 1, [&](int) {
+            keep(bot.search(board, current, next).score);
+        });
+        runner.run("Bot::search<StandardBoard>" + suffix, 1, [&](int) {
+            keep(bot.search(fixed, current, next).score);
+        });
+    }
+}
+
+// One batch of rollouts for a single placement: the unit of work RolloutEvaluator hands
+// to each thread.
+void benchRollout(BenchRunner& runner) {
+    Xoshiro256 rng(17);
+    Board board = makeBoard(25, rng);
+    Tetromino spawn = GameState::makeSpawnTetromino(TetrominoType::T, board.getCols());
+    BotMove moves[Bot::MAX_PLACEMENTS];
+    Bot::listPlacements(board, spawn, moves);
+    const std::vector<Tetromino> placements = {moves[0].target};
+
+    RolloutEvaluator evaluator;
+    RolloutOptions options;
+    options.rollouts = RolloutEvaluator::BATCH_SIZE;
+    options.depth = 50;
+    runner.run("RolloutEvaluator [8 rollouts x 50 pieces]", 1, [&](int) {
+        options.seed++;
+        keep(evaluator.evaluate(board, placements, options)[0].meanScore);
+    });
+}
+
+// Saving and forking games: a tall Board copy shares its rows until one side writes, and a
+// write clones just the block it lands in. Standard boards are copied inline.
+void benchFork(BenchRunner& runner) {
+    Xoshiro256 rng(13);
+    Board tall = makeBoard(50, rng, {4000, 10});
+    Tetromino piece(TetrominoType::T, Position(3, 0));
+    runner.run("Board copy [4000x10]", 256, [&](int) {
+        Board copy = tall;
+        keep(copy);
+    });
+    runner.run("Board copy + mergeTetromino [4000x10]", 64, [&](int) {
+        Board copy = tall;
+        copy.mergeTetromino(piece);
+        keep(copy);
+    });
+
+    Simulator simulator(Simulator::DEFAULT_TICK_MS, 5);
+    simulator.apply(Command::HardDrop);
+    Simulator::Checkpoint checkpoint = simulator.save();
+    runner.run("Simulator save + restore", 256, [&](int) {
+        Simulator::Checkpoint saved = simulator.save();
+        simulator.restore(checkpoint);
+        keep(saved.now);
+    });
+    // The rollback pattern: restore, then replay inputs on top of the restored board.
+    runner.run("Simulator restore + hard drop", 64, [&](int) {
+        simulator.restore(checkpoint);
+        simulator.apply(Command::HardDrop);
+    });
+}
+
+// Recording frames: the rectangle loops, a whole frame of a game in progress, and PNG
+// encoding. A game recorded at 60 fps needs all of it well under 16 ms per frame.
+void benchSoftwareRender(BenchRunner& runner) {
+    Framebuffer framebuffer(WINDOW_WIDTH, WINDOW_HEIGHT);
+    runner.run("Framebuffer::fillRect [500x600]", 4, [&](int i) {
+        framebuffer.fillRect(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, {static_cast<uint8_t>(i), 0, 0, 255});
+    });
+    runner.run("Framebuffer::blendRect [500x600]", 4, [&](int) {
+        framebuffer.blendRect(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, {0, 0, 0, 150});
+    });
+
+    Simulator simulator(Simulator::DEFAULT_TICK_MS, 9);
+    Bot bot;
+    while (simulator.getState().getPiecesPlaced() < 60 && !simulator.getState().isGameOver()) {
+        BotMove move = bot.plan(simulator.getState());
+        for (int i = 0; i < move.commandCount; ++i) {
+            simulator.apply(move.commands[i]);
+        }
+        simulator.tick();
+    }
+    SoftwareRenderer renderer;
+    runner.run("SoftwareRenderer::draw", 4, [&](int) { keep(renderer.draw(simulator.getState()).getPixel(0, 0)); });
+
+    std::vector<uint8_t> png;
+    FrameWriter::encodePng(renderer.getFrame(), png);
+    runner.run("FrameWriter::encodePng [500x600]", 1, [&](int) {
+        FrameWriter::encodePng(renderer.getFrame(), png);
+        keep(png.size());
+    });
+}
+
+void benchTetromino(BenchRunner& runner) {
+    Tetromino piece(TetrominoType::T, Position(3, 0));
+    runner.run("Tetromino::rotate", 1024, [&](int) {
+        piece.rotate();
+        keep(piece);
+    });
+}
+
+void benchHandleInput(BenchRunner& runner) {
+    struct InputBench {
+        Command command;
+        int batchSize;
+    };
+    // Batches stay small enough that a fresh game never runs out of room mid-sample.
+    const InputBench inputs[] = {
+        {Command::Left, 4}, {Command::Right, 4}, {Command::Down, 16},
+        {Command::Rotate, 16}, {Command::HardDrop, 8}, {Command::Pause, 16}
+    };
+
+    GameState state;
+    for (const auto& input : inputs) {
+        uint64_t seed = 1;
+        runner.run(std::string("GameState::handleInput ") + commandName(input.command), input.batchSize,
+                   [&]() { state.reset(seed++); },
+                   [&](int) { state.handleInput(input.command); });
+    }
+}
+
+void benchUpdate(BenchRunner& runner) {
+    // One simulator tick per gravity interval, so every update moves or locks the piece.
+    Simulator simulator(GameState::TICK_INTERVAL);
+    uint64_t seed = 1;
+    runner.run("GameState::update (gravity tick)", 32,
+               [&]() { simulator.reset(seed++); },
+               [&](int) { simulator.tick(); });
+}
+
+// A bot game sampled once per server tick, with one command every few ticks, as a
+// server would see a fast human player.
+std::vector<Snapshot> recordGameTicks(int tickCount) {
+    Simulator simulator(Simulator::DEFAULT_TICK_MS, 7);
+    Bot bot;
+    BotMove move;
+    int nextCommand = 0;
+    std::vector<Snapshot> ticks;
+
+    while (static_cast<int>(ticks.size()) < tickCount) {
+        if (simulator.getState().isGameOver()) {
+            simulator.reset(ticks.size());
+        }
+        if (nextCommand >= move.commandCount) {
+            move = bot.plan(simulator.getState());
+            nextCommand = 0;
+        }
+        if (ticks.size() % 4 == 0 && nextCommand < move.commandCount) {
+            simulator.apply(move.commands[nextCommand++]);
+        }
+        simulator.tick();
+        ticks.push_back(Snapshot::capture(simulator.getState(), simulator.getTickCount()));
+    }
+    return ticks;
+}
+
+void benchSnapshots(BenchRunner& runner) {
+    const int TICKS = 4096;
+    const std::vector<Snapshot> ticks = recordGameTicks(TICKS);
+
+    SnapshotEncoder encoder;
+    std::vector<uint8_t> out;
+    out.reserve(256);
+    int next = 0;
+    // The viewer has acknowledged the previous generation, the common case on a LAN.
+    runner.run("SnapshotEncoder capture + delta (per tick)", 64, [&](int) {
+        out.clear();
+        if (encoder.capture(ticks[next++ % TICKS])) {
+            encoder.encode(out, 0, encoder.getGeneration() - 1);
+        }
+        keep(out.data());
+    });
+    runner.run("SnapshotEncoder keyframe", 64, [&](int) {
+        out.clear();
+        encoder.encodeKeyframe(out, 0);
+        keep(out.data());
+    });
+
+    // Bandwidth for one viewer over the whole game: a full board per change (the old
+    // 65-byte State frame), a delta per change, and a keyframe per change.
+    SnapshotEncoder replay;
+    std::vector<std::vector<uint8_t>> deltas;
+    long long changes = 0;
+    long long deltaBytes = 0;
+    long long keyframeBytes = 0;
+    for (const Snapshot& tick : ticks) {
+        if (!replay.capture(tick)) {
+            continue;
+        }
+        changes++;
+        std::vector<uint8_t> frame;
+        replay.encode(frame, 0, replay.getGeneration() - 1);
+        deltaBytes += static_cast<long long>(frame.size());
+        deltas.push_back(frame);
+        out.clear();
+        replay.encodeKeyframe(out, 0);
+        keyframeBytes += static_cast<long long>(out.size());
+    }
+
+    SnapshotDecoder decoder;
+    std::size_t decoded = 0;
+    runner.run("SnapshotDecoder apply (per update)", 64,
+               [&]() {
+                   // Restart from the first frame (a keyframe) so every delta has its base.
+                   if (decoded + 64 > deltas.size()) {
+                       decoder = SnapshotDecoder();
+                       decoded = 0;
+                   }
+               },
+               [&](int) {
+                   const std::vector<uint8_t>& frame = deltas[decoded++];
+                   decoder.apply(static_cast<MessageType>(frame[2]), frame.data() + FRAME_HEADER_SIZE,
+                                 frame.size() - FRAME_HEADER_SIZE);
+                   keep(decoder.getGeneration());
+               });
+
+    const double seconds = TICKS * Simulator::DEFAULT_TICK_MS / 1000.0;
+    const long long fullBytes = changes * 65;
+    std::cout << std::fixed << std::setprecision(1)
+              << "snapshot bandwidth per viewer over " << seconds << " s of play (" << changes << " of "
+              << TICKS << " ticks changed the board):\n"
+              << "  full state  " << std::setw(8) << fullBytes / seconds << " B/s\n"
+              << "  keyframes   " << std::setw(8) << keyframeBytes / seconds << " B/s\n"
+              << "  deltas      " << std::setw(8) << deltaBytes / seconds << " B/s ("
+              << static_cast<double>(deltaBytes) / changes << " B/update)" << std::endl;
+}
+
+// Steady-state play must not touch the heap, or long sessions grow without bound. A bot
+// plays `pieceCount` pieces (spawn, rotate, move, gravity, hard drop, line clears and a
+// restart every GAME_LENGTH pieces or on game over); only the simulator calls are
+// counted, not the bot's search.
+bool auditAllocations(int pieceCount) {
+    const int GAME_LENGTH = 1000;
+    Simulator simulator(Simulator::DEFAULT_TICK_MS, 3);
+    Bot bot;
+    long long allocations = 0;
+    auto counted = [&](auto&& call) {
+        long long before = allocationCount.load(std::memory_order_relaxed);
+        call();
+        allocations += allocationCount.load(std::memory_order_relaxed) - before;
+    };
+
+    int pieces = 0;
+    int lines = 0;
+    int games = 1;
+    while (pieces + simulator.getState().getPiecesPlaced() < pieceCount) {
+        const GameState& state = simulator.getState();
+        if (state.isGameOver() || state.getPiecesPlaced() >= GAME_LENGTH) {
+            pieces += state.getPiecesPlaced();
+            lines += state.getLinesCleared();
+            counted([&]() { simulator.reset(games++); });
+            continue;
+        }
+        BotMove move = bot.plan(state);
+        if (!move.valid) {
+            move.commands[0] = Command::HardDrop;
+            move.commandCount = 1;
+        }
+        for (int i = 0; i < move.commandCount; ++i) {
+            counted([&]() {
+                simulator.apply(move.commands[i]);
+                simulator.tick(8);
+            });
+        }
+    }
+    pieces += simulator.getState().getPiecesPlaced();
+    lines += simulator.getState().getLinesCleared();
+
+    std::cout << "Allocation audit: " << pieces << " pieces, " << lines << " lines, " << games << " games, "
+              << allocations << " allocations" << (allocations == 0 ? "" : " (expected none)") << std::endl;
+    return allocations == 0;
+}
+
+#ifdef TETRIS_BENCH_RENDER
+void benchRender(BenchRunner& runner) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, WINDOW_WIDTH, WINDOW_HEIGHT, 32, SDL_PIXELFORMAT_RGBA8888);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!renderer) {
+        std::cerr << "Offscreen renderer unavailable: " << SDL_GetError() << std::endl;
+        SDL_FreeSurface(surface);
+        return;
+    }
+
+    {
+        Game game;
+        if (game.initializeOffscreen(renderer)) {
+            runner.run("Game::render (software)", 16, [&](int) { game.render(); });
+        }
+    }
+
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+}
+#endif
+
+}
+
+int main(int argc, char* argv[]) {
+    int samples = 200;
+    std::string outPath = "bench_results.json";
+    if (argc == 2 && std::string(argv[1]) == "--audit") {
+        return auditAllocations(5000) ? 0 : 1;
+    }
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--samples") {
+            samples = std::max(10, std::atoi(argv[i + 1]));
+        } else if (arg == "--out") {
+            outPath = argv[i + 1];
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << std::left << std::setw(52) << "benchmark" << std::right << std::setw(12) << "median ns"
+              << std::setw(12) << "p99 ns" << std::setw(12) << "allocs/op" << std::endl;
+
+    BenchRunner runner(samples);
+    benchBoard(runner);
+    benchBot(runner);
+    benchFork(runner);
+    benchRollout(runner);
+    benchSoftwareRender(runner);
+    benchTetromino(runner);
+    benchHandleInput(runner);
+    benchUpdate(runner);
+    benchSnapshots(runner);
+#ifdef TETRIS_BENCH_RENDER
+    benchRender(runner);
+#endif
+    bool allocationFree = auditAllocations(5000);
+
+    if (!runner.writeJson(outPath)) {
+        std::cerr << "Cannot write " << outPath << std::endl;
+        return 1;
+    }
+    std::cout << "Results written to " << outPath << std::endl;
+    return allocationFree ? 0 : 1;
+}
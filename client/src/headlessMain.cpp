@@ -0,0 +1,509 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Bot.h"
+#include "FrameWriter.h"
+#include "Profiler.h"
+#include "Replay.h"
+#include "Rollout.h"
+#include "Simulator.h"
+#include "SoftwareRenderer.h"
+#include "WorkerPool.h"
+
+// Batch runner: plays many independent games without a display and reports throughput.
+//
+//   tetris_headless [--games N] [--threads T] [--script FILE] [--seeds FILE] [--max-pieces P]
+//                   [--record DIR] [--bag] [--bot] [--rows R] [--cols C]
+//   tetris_headless --replay FILE [--realtime] [--frames DIR] [--png] [--fps F] [--thumbnail PNG]
+//   tetris_headless --replay FILE --grade [--rollouts N] [--depth D] [--threads T] [--max-pieces P]
+//
+// With --script every game replays the same command file (see Simulator::run).
+// Otherwise each game is driven by random commands drawn from its seed. The seed also
+// drives the piece sequence, so every run is reproducible; --bag uses the 7-bag randomizer.
+// --bot lets the placement search bot play instead of random inputs. --rows and --cols
+// set the board size, up to 65535 rows and 64 columns, for marathon runs.
+// --record writes one DIR/game_<n>.trpl replay log per game; --replay streams a log
+// back through the simulation, as fast as possible or at --realtime speed. --frames draws
+// the replay with SoftwareRenderer at F frames per second of game time (60 by default)
+// into DIR/frames.rgba, or into numbered PNGs with --png; --thumbnail saves the final
+// frame. To film a bot game, --record it and replay the log. With --grade
+// every placement in the log is ranked against all the others by Monte Carlo rollouts
+// (see RolloutEvaluator): N sampled futures of D pieces each, on T threads.
+
+struct RunnerOptions {
+    int games = 1000;
+    int threads = 0;
+    int maxPieces = 1000;
+    std::string scriptPath;
+    std::string seedsPath;
+    std::string recordDir;
+    std::string replayPath;
+    bool realtime = false;
+    bool grade = false;
+    std::string framesDir;
+    std::string thumbnailPath;
+    FrameFormat frameFormat = FrameFormat::Raw;
+    int fps = 60;
+    int rollouts = 256;
+    int depth = 50;
+    Randomizer randomizer = Randomizer::Uniform;
+    bool bot = false;
+    BoardSize boardSize = Board::DEFAULT_SIZE;
+};
+
+struct GameResult {
+    int pieces = 0;
+    int lines = 0;
+    int score = 0;
+    // False when --record was given and the replay could not be written in full.
+    bool recorded = true;
+};
+
+static const Command RANDOM_COMMANDS[] = {Command::Left, Command::Right, Command::Down, Command::Rotate, Command::HardDrop};
+
+static bool parseOptions(int argc, char* argv[], RunnerOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--realtime") {
+            options.realtime = true;
+            continue;
+        }
+        if (arg == "--bag") {
+            options.randomizer = Randomizer::SevenBag;
+            continue;
+        }
+        if (arg == "--bot") {
+            options.bot = true;
+            continue;
+        }
+        if (arg == "--grade") {
+            options.grade = true;
+            continue;
+        }
+        if (arg == "--png") {
+            options.frameFormat = FrameFormat::Png;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--games") {
+            options.games = std::atoi(value.c_str());
+        } else if (arg == "--threads") {
+            options.threads = std::atoi(value.c_str());
+        } else if (arg == "--max-pieces") {
+            options.maxPieces = std::atoi(value.c_str());
+        } else if (arg == "--script") {
+            options.scriptPath = value;
+        } else if (arg == "--seeds") {
+            options.seedsPath = value;
+        } else if (arg == "--record") {
+            options.recordDir = value;
+        } else if (arg == "--replay") {
+            options.replayPath = value;
+        } else if (arg == "--rows") {
+            options.boardSize.rows = std::atoi(value.c_str());
+        } else if (arg == "--cols") {
+            options.boardSize.cols = std::atoi(value.c_str());
+        } else if (arg == "--rollouts") {
+            options.rollouts = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--depth") {
+            options.depth = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--frames") {
+            options.framesDir = value;
+        } else if (arg == "--fps") {
+            options.fps = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--thumbnail") {
+            options.thumbnailPath = value;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::vector<std::string> readLines(const std::string& path) {
+    std::vector<std::string> lines;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) {
+            lines.push_back(line);
+        }
+    }
+    return lines;
+}
+
+static GameResult resultOf(const Simulator& simulator) {
+    const GameState& state = simulator.getState();
+    return {state.getPiecesPlaced(), state.getLinesCleared(), state.getScore()};
+}
+
+static GameResult playGame(const RunnerOptions& options, const std::vector<std::string>& script, uint32_t seed, int index) {
+    Simulator simulator(Simulator::DEFAULT_TICK_MS, seed, options.randomizer, options.boardSize);
+
+    ReplayWriter recorder;
+    std::string recordPath;
+    bool recorded = true;
+    if (!options.recordDir.empty()) {
+        recordPath = options.recordDir + "/game_" + std::to_string(index) + ".trpl";
+        if (recorder.open(recordPath, seed, options.randomizer, simulator.getTickMs(),
+                          simulator.getState().getBoard().getSize())) {
+            simulator.setRecorder(&recorder);
+        } else {
+            recorded = false;
+        }
+    }
+
+    if (!script.empty()) {
+        simulator.run(script);
+    } else if (options.bot) {
+        // Games already run one per core, so each bot searches serially.
+        Bot bot;
+        const GameState& state = simulator.getState();
+
+        while (!state.isGameOver() && state.getPiecesPlaced() < options.maxPieces) {
+            BotMove move = bot.plan(state);
+            for (int i = 0; i < move.commandCount; ++i) {
+                simulator.apply(move.commands[i]);
+            }
+            simulator.tick();
+        }
+    } else {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> pick(0, 4);
+        const GameState& state = simulator.getState();
+
+        while (!state.isGameOver() && state.getPiecesPlaced() < options.maxPieces) {
+            simulator.apply(RANDOM_COMMANDS[pick(rng)]);
+            simulator.tick();
+        }
+    }
+
+    if (recorder.isOpen() && !recorder.close(simulator.getTickCount())) {
+        recorded = false;
+    }
+    if (!recorded) {
+        std::cerr << "Cannot write replay: " << recordPath << std::endl;
+    }
+    GameResult result = resultOf(simulator);
+    result.recorded = recorded;
+    return result;
+}
+
+static int replayGame(const RunnerOptions& options) {
+    ReplayReader reader;
+    if (!reader.open(options.replayPath)) {
+        std::cerr << "Cannot read replay: " << options.replayPath << std::endl;
+        return 1;
+    }
+
+    FrameWriter frames;
+    if (!options.framesDir.empty() && !frames.open(options.framesDir, options.frameFormat)) {
+        std::cerr << "Cannot write frames to " << options.framesDir << std::endl;
+        return 1;
+    }
+    SoftwareRenderer renderer;
+    double renderSeconds = 0;
+    double writeSeconds = 0;
+    bool framesFailed = false;
+
+    Simulator simulator(reader.getTickMs(), reader.getSeed(), reader.getRandomizer(), reader.getBoardSize());
+    auto start = std::chrono::steady_clock::now();
+    auto tickTo = [&](uint32_t tick) {
+        if (tick > simulator.getTickCount()) {
+            simulator.tick(static_cast<int>(tick - simulator.getTickCount()));
+        }
+    };
+    // Frame n shows the game as it stood at n / fps seconds, before any input at that tick.
+    auto captureUntil = [&](uint32_t tick) {
+        while (frames.isOpen() && !framesFailed) {
+            uint64_t frameMs = static_cast<uint64_t>(frames.getFrameCount()) * 1000 / options.fps;
+            uint64_t frameTick = frameMs / simulator.getTickMs();
+            if (frameTick > tick) {
+                break;
+            }
+            tickTo(static_cast<uint32_t>(frameTick));
+            auto renderStart = std::chrono::steady_clock::now();
+            const Framebuffer& frame = renderer.draw(simulator.getState());
+            auto writeStart = std::chrono::steady_clock::now();
+            framesFailed = !frames.write(frame);
+            auto writeEnd = std::chrono::steady_clock::now();
+            renderSeconds += std::chrono::duration<double>(writeStart - renderStart).count();
+            writeSeconds += std::chrono::duration<double>(writeEnd - writeStart).count();
+        }
+    };
+    auto advanceTo = [&](uint32_t tick) {
+        captureUntil(tick);
+        tickTo(tick);
+        if (options.realtime) {
+            std::this_thread::sleep_until(start + std::chrono::milliseconds(simulator.getTime()));
+        }
+    };
+
+    ReplayEvent event;
+    while (reader.next(event)) {
+        advanceTo(event.tick);
+        simulator.apply(event.command);
+    }
+    advanceTo(reader.getFinalTick());
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    GameResult result = resultOf(simulator);
+    std::cout << "replayed:    " << simulator.getTickCount() << " ticks in " << seconds << " s\n"
+              << "pieces:      " << result.pieces << "\n"
+              << "lines:       " << result.lines << "\n"
+              << "score:       " << result.score << std::endl;
+
+    if (frames.isOpen()) {
+        int count = frames.getFrameCount();
+        const Framebuffer& frame = renderer.getFrame();
+        double gameSeconds = simulator.getTime() / 1000.0;
+        std::cout << "frames:      " << count << " of " << frame.getWidth() << "x" << frame.getHeight() << " at "
+                  << options.fps << " fps, " << frames.getBytesWritten() / 1024 << " KiB\n"
+                  << "render:      " << (count ? renderSeconds / count * 1e6 : 0) << " us/frame\n"
+                  << "write:       " << (count ? writeSeconds / count * 1e6 : 0) << " us/frame\n"
+                  << "speed:       " << gameSeconds / std::max(seconds, 1e-9) << "x real time" << std::endl;
+        if (options.frameFormat == FrameFormat::Raw) {
+            std::cout << "encode with: ffmpeg -f rawvideo -pix_fmt rgba -s " << frame.getWidth() << "x"
+                      << frame.getHeight() << " -r " << options.fps << " -i " << options.framesDir
+                      << "/frames.rgba game.mp4" << std::endl;
+        }
+        frames.close();
+    }
+    if (framesFailed) {
+        std::cerr << "Cannot write frames to " << options.framesDir << std::endl;
+        return 1;
+    }
+
+    if (!options.thumbnailPath.empty() &&
+        !FrameWriter::writePng(options.thumbnailPath, renderer.draw(simulator.getState()))) {
+        std::cerr << "Cannot write thumbnail: " << options.thumbnailPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+static bool samePlacement(const Tetromino& a, const Tetromino& b) {
+    if (a.getPosition().x != b.getPosition().x || a.getPosition().y != b.getPosition().y) {
+        return false;
+    }
+    for (int row = 0; row < MAX_SHAPE_SIZE; ++row) {
+        if (a.getRowMask(row) != b.getRowMask(row)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int gradeReplay(const RunnerOptions& options) {
+    ReplayReader reader;
+    if (!reader.open(options.replayPath)) {
+        std::cerr << "Cannot read replay: " << options.replayPath << std::endl;
+        return 1;
+    }
+
+    Simulator simulator(reader.getTickMs(), reader.getSeed(), reader.getRandomizer(), reader.getBoardSize());
+    const GameState& state = simulator.getState();
+
+    // The calling thread plays rollouts too, so the pool gets one worker fewer.
+    int threadCount = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    std::unique_ptr<WorkerPool> pool;
+    if (threadCount > 1) {
+        pool = std::make_unique<WorkerPool>(threadCount - 1);
+    }
+    RolloutEvaluator evaluator(pool.get());
+    RolloutOptions rolloutOptions;
+    rolloutOptions.rollouts = options.rollouts;
+    rolloutOptions.depth = options.depth;
+    rolloutOptions.randomizer = reader.getRandomizer();
+
+    std::vector<BotMove> moves(Bot::MAX_PLACEMENTS);
+    std::vector<Tetromino> placements;
+    int graded = 0;
+    int bestPlayed = 0;
+    double totalLoss = 0;
+    long long rolloutsPlayed = 0;
+
+    auto grade = [&](const Board& board, const Tetromino& played) {
+        Tetromino spawn = GameState::makeSpawnTetromino(played.getType(), board.getCols());
+        int count = Bot::listPlacements(board, spawn, moves.data());
+        placements.clear();
+        int playedIndex = -1;
+        for (int i = 0; i < count; ++i) {
+            placements.push_back(moves[i].target);
+            if (samePlacement(moves[i].target, played)) {
+                playedIndex = i;
+            }
+        }
+        // Tucks and spins are out of the bot's reach; grade them all the same.
+        if (playedIndex < 0) {
+            playedIndex = static_cast<int>(placements.size());
+            placements.push_back(played);
+        }
+
+        rolloutOptions.seed = reader.getSeed() + graded;
+        std::vector<RolloutStats> stats = evaluator.evaluate(board, placements, rolloutOptions);
+        rolloutsPlayed += static_cast<long long>(placements.size()) * options.rollouts;
+
+        int best = 0;
+        int rank = 1;
+        for (int i = 0; i < static_cast<int>(stats.size()); ++i) {
+            if (stats[i].meanScore > stats[best].meanScore) {
+                best = i;
+            }
+            if (stats[i].meanScore > stats[playedIndex].meanScore) {
+                rank++;
+            }
+        }
+        bestPlayed += rank == 1 ? 1 : 0;
+        totalLoss += stats[best].meanScore - stats[playedIndex].meanScore;
+        graded++;
+
+        std::cout << "piece " << std::setw(5) << graded << "  rank " << std::setw(3) << rank << "/"
+                  << std::left << std::setw(3) << stats.size() << std::right << std::fixed << std::setprecision(1)
+                  << "  played " << std::setw(7) << stats[playedIndex].meanScore << " pts "
+                  << std::setw(5) << 100 * stats[playedIndex].survivalRate << "% survive"
+                  << "  best " << std::setw(7) << stats[best].meanScore << " pts "
+                  << std::setw(5) << 100 * stats[best].survivalRate << "% survive" << std::endl;
+    };
+
+    // Gravity and the lock delay only ever move a piece down, so a piece that locks during
+    // a step rests where a hard drop from its position before the step would have put it.
+    auto step = [&](auto&& action) {
+        Board before = state.getBoard();
+        Tetromino piece = state.getCurrentTetromino();
+        int placed = state.getPiecesPlaced();
+        action();
+        if (state.getPiecesPlaced() == placed + 1 && graded < options.maxPieces) {
+            while (!before.checkCollision(piece, 0, 1)) {
+                piece.move(0, 1);
+            }
+            grade(before, piece);
+        }
+    };
+    // Tick by tick, so that gravity can never lock two pieces in one step. Ticks go on
+    // through a game over so that a restart lands on the tick it was recorded at.
+    auto advanceTo = [&](uint32_t tick) {
+        while (simulator.getTickCount() < tick) {
+            step([&]() { simulator.tick(); });
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    ReplayEvent event;
+    while (reader.next(event) && graded < options.maxPieces) {
+        advanceTo(event.tick);
+        if (event.command == Command::Restart) {
+            // Resets the piece count; nothing is placed.
+            simulator.apply(event.command);
+        } else {
+            step([&]() { simulator.apply(event.command); });
+        }
+    }
+    if (graded < options.maxPieces) {
+        advanceTo(reader.getFinalTick());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "graded:      " << graded << " pieces, " << rolloutsPlayed << " rollouts of " << options.depth
+              << " pieces in " << seconds << " s (" << rolloutsPlayed / seconds << " rollouts/sec on "
+              << std::max(1, threadCount) << " threads)\n"
+              << "best moves:  " << bestPlayed << "\n"
+              << "avg loss:    " << (graded ? totalLoss / graded : 0) << " pts/piece" << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    RunnerOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    if (!options.replayPath.empty()) {
+        return options.grade ? gradeReplay(options) : replayGame(options);
+    }
+
+    std::vector<std::string> script;
+    if (!options.scriptPath.empty()) {
+        script = readLines(options.scriptPath);
+        if (script.empty()) {
+            std::cerr << "Script is empty or unreadable: " << options.scriptPath << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<uint32_t> seeds;
+    if (!options.seedsPath.empty()) {
+        for (const auto& line : readLines(options.seedsPath)) {
+            seeds.push_back(static_cast<uint32_t>(std::strtoul(line.c_str(), nullptr, 10)));
+        }
+        options.games = static_cast<int>(seeds.size());
+    } else {
+        for (int i = 0; i < options.games; ++i) {
+            seeds.push_back(static_cast<uint32_t>(i + 1));
+        }
+    }
+
+    int threadCount = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = std::max(1, std::min(threadCount, options.games));
+
+    std::vector<GameResult> results(options.games);
+    std::atomic<int> nextGame(0);
+
+    auto start = std::chrono::steady_clock::now();
+
+    PROFILE_START("tetris_trace.json");
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&]() {
+            PROFILE_THREAD("game");
+            for (int game = nextGame++; game < options.games; game = nextGame++) {
+                results[game] = playGame(options, script, seeds[game], game);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    PROFILE_STOP();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long long pieces = 0;
+    long long lines = 0;
+    long long score = 0;
+    int unrecorded = 0;
+    for (const auto& result : results) {
+        pieces += result.pieces;
+        lines += result.lines;
+        score += result.score;
+        unrecorded += result.recorded ? 0 : 1;
+    }
+
+    std::cout << "games:       " << options.games << " on " << threadCount << " threads\n"
+              << "elapsed:     " << seconds << " s\n"
+              << "pieces:      " << pieces << " (" << pieces / seconds << " pieces/sec)\n"
+              << "lines:       " << lines << " (" << lines / seconds << " lines/sec)\n"
+              << "avg score:   " << (options.games ? score / options.games : 0) << std::endl;
+    if (unrecorded > 0) {
+        std::cerr << unrecorded << " of " << options.games << " replays could not be written" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+#include <cstdlib>
+#include <string>
+#include "Game.h"
+#include "NetClient.h"
+
+// Usage: tetris_online [host] [port] [room] [--spectate [board]]
+// Plays one board on a tetris_server; other players who join the same room share the
+// piece sequence. With --spectate it only watches one board of the room (slot 0 unless
+// given).
+int main(int argc, char* argv[]) {
+    std::string host = argc > 1 ? argv[1] : "127.0.0.1";
+    uint16_t port = static_cast<uint16_t>(argc > 2 ? std::atoi(argv[2]) : 7777);
+    uint32_t room = static_cast<uint32_t>(argc > 3 ? std::atoi(argv[3]) : 0);
+    bool spectate = argc > 4 && std::string(argv[4]) == "--spectate";
+
+    NetClient client;
+    if (!client.connect(host, port, room, spectate)) {
+        return 1;
+    }
+    if (spectate && argc > 5) {
+        client.watch(std::atoi(argv[5]));
+    }
+
+    Game game;
+    if (!game.initialize()) {
+        return 1;
+    }
+    game.setRemote(&client);
+    game.gameLoop();
+    return 0;
+}
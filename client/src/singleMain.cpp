@@ -1,11 +1,17 @@
 #include "Game.h"
+#include "Profiler.h"
 
 int main() {
-    Game game;
-    if (!game.initialize()) {
-        return 1;
+    PROFILE_START("tetris_trace.json");
+    {
+        Game game;
+        if (!game.initialize()) {
+            PROFILE_STOP();
+            return 1;
+        }
+        game.gameLoop();
     }
-    game.gameLoop();
+    PROFILE_STOP();
     return 0;
 }
 
@@ -0,0 +1,378 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Bot.h"
+#include "Random.h"
+#include "Simulator.h"
+#include "WorkerPool.h"
+
+// Genetic tuner for the bot's heuristic weights.
+//
+//   tetris_tune [--population N] [--games G] [--max-pieces P] [--generations N] [--threads T]
+//               [--seed S] [--bag] [--lookahead] [--checkpoint FILE] [--resume]
+//
+// Every generation each weight vector plays G seeded games of at most P pieces, and its
+// fitness is the mean score. All vectors in a generation play the same seeds (common
+// random numbers), so they are ranked on the same piece sequences rather than on luck;
+// survivors are re-scored on each generation's new seeds. The bot places pieces
+// greedily by default, or with its full two-piece search under --lookahead.
+//
+// Each generation keeps the fittest vectors and replaces the rest with offspring: two
+// tournament winners are blended in proportion to their fitness, occasionally mutated,
+// and normalized to unit length (only the direction of the vector matters to the bot).
+// The population and the run's settings are written to the checkpoint after every
+// generation; --resume picks up from it, and then only --generations, --threads and
+// --checkpoint apply from the command line. The random choices of a generation derive
+// from the seed and the generation number, so a resumed run continues exactly as an
+// uninterrupted one would.
+
+namespace {
+
+struct TuneOptions {
+    int population = 64;
+    int games = 32;
+    int maxPieces = 500;
+    int generations = 50;
+    int threads = 0;
+    uint64_t seed = 1;
+    Randomizer randomizer = Randomizer::Uniform;
+    bool lookahead = false;
+    std::string checkpointPath = "tune_checkpoint.txt";
+    bool resume = false;
+};
+
+const int WEIGHT_COUNT = 4;
+// Share of the population replaced by offspring every generation.
+const double OFFSPRING_SHARE = 0.3;
+// Share of the population drawn into each tournament.
+const double TOURNAMENT_SHARE = 0.1;
+const double MUTATION_RATE = 0.05;
+const double MUTATION_STEP = 0.2;
+const int CHECKPOINT_VERSION = 1;
+
+// BotWeights as a vector, in declaration order.
+using WeightVector = std::array<double, WEIGHT_COUNT>;
+
+struct Genome {
+    WeightVector weights = {};
+    double fitness = 0;
+};
+
+WeightVector toVector(const BotWeights& weights) {
+    return {weights.aggregateHeight, weights.linesCleared, weights.holes, weights.bumpiness};
+}
+
+BotWeights toWeights(const WeightVector& vector) {
+    BotWeights weights;
+    weights.aggregateHeight = vector[0];
+    weights.linesCleared = vector[1];
+    weights.holes = vector[2];
+    weights.bumpiness = vector[3];
+    return weights;
+}
+
+void normalize(WeightVector& weights) {
+    double length = 0;
+    for (double w : weights) {
+        length += w * w;
+    }
+    length = std::sqrt(length);
+    if (length == 0) {
+        weights[0] = -1;
+        return;
+    }
+    for (double& w : weights) {
+        w /= length;
+    }
+}
+
+bool parseOptions(int argc, char* argv[], TuneOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--bag") {
+            options.randomizer = Randomizer::SevenBag;
+            continue;
+        }
+        if (arg == "--lookahead") {
+            options.lookahead = true;
+            continue;
+        }
+        if (arg == "--resume") {
+            options.resume = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--population") {
+            options.population = std::max(4, std::atoi(value.c_str()));
+        } else if (arg == "--games") {
+            options.games = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--max-pieces") {
+            options.maxPieces = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--generations") {
+            options.generations = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--threads") {
+            options.threads = std::atoi(value.c_str());
+        } else if (arg == "--seed") {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--checkpoint") {
+            options.checkpointPath = value;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Text, one genome per line, so a run can be inspected or edited by hand:
+//   tetris_tune <version>
+//   seed <seed> generation <next generation> population <N> games <G> pieces <P> bag <0|1> lookahead <0|1>
+//   <aggregateHeight> <linesCleared> <holes> <bumpiness>   (N lines)
+// Written to a temporary file and renamed over the old one, so an interrupted write
+// never leaves a truncated checkpoint behind.
+bool saveCheckpoint(const std::string& path, const TuneOptions& options, int generation,
+                    const std::vector<Genome>& population) {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary);
+        if (!out) {
+            return false;
+        }
+        out << "tetris_tune " << CHECKPOINT_VERSION << "\n"
+            << "seed " << options.seed << " generation " << generation << " population " << population.size()
+            << " games " << options.games << " pieces " << options.maxPieces
+            << " bag " << (options.randomizer == Randomizer::SevenBag ? 1 : 0)
+            << " lookahead " << (options.lookahead ? 1 : 0) << "\n"
+            << std::setprecision(17);
+        for (const Genome& genome : population) {
+            for (int i = 0; i < WEIGHT_COUNT; ++i) {
+                out << genome.weights[i] << (i + 1 < WEIGHT_COUNT ? " " : "\n");
+            }
+        }
+        if (!out) {
+            return false;
+        }
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+bool loadCheckpoint(const std::string& path, TuneOptions& options, int& generation, std::vector<Genome>& population) {
+    std::ifstream in(path);
+    std::string magic;
+    int version = 0;
+    std::string key[7];
+    int size = 0;
+    int bag = 0;
+    int lookahead = 0;
+    if (!(in >> magic >> version >> key[0] >> options.seed >> key[1] >> generation >> key[2] >> size
+             >> key[3] >> options.games >> key[4] >> options.maxPieces >> key[5] >> bag >> key[6] >> lookahead) ||
+        magic != "tetris_tune" || version != CHECKPOINT_VERSION || size < 1 || options.games < 1) {
+        return false;
+    }
+    options.randomizer = bag ? Randomizer::SevenBag : Randomizer::Uniform;
+    options.lookahead = lookahead != 0;
+
+    population.assign(size, Genome());
+    for (Genome& genome : population) {
+        for (double& w : genome.weights) {
+            if (!(in >> w)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::vector<Genome> randomPopulation(int size, Xoshiro256& rng) {
+    std::vector<Genome> population(size);
+    // The stock weights compete too.
+    population[0].weights = toVector(BotWeights());
+    for (int i = 1; i < size; ++i) {
+        for (double& w : population[i].weights) {
+            w = rng.nextDouble() * 2 - 1;
+        }
+    }
+    for (Genome& genome : population) {
+        normalize(genome.weights);
+    }
+    return population;
+}
+
+struct GameResult {
+    int score = 0;
+    int pieces = 0;
+};
+
+GameResult playGame(const BotWeights& weights, const TuneOptions& options, uint64_t seed) {
+    Simulator simulator(Simulator::DEFAULT_TICK_MS, seed, options.randomizer);
+    // A zero budget makes the bot skip its lookahead and rank placements on the current
+    // piece alone; an unlimited one makes the full search deterministic.
+    auto budget = options.lookahead ? std::chrono::microseconds(std::chrono::hours(1))
+                                    : std::chrono::microseconds(0);
+    Bot bot(weights, nullptr, budget);
+    const GameState& state = simulator.getState();
+
+    while (!state.isGameOver() && state.getPiecesPlaced() < options.maxPieces) {
+        BotMove move = bot.plan(state);
+        for (int i = 0; i < move.commandCount; ++i) {
+            simulator.apply(move.commands[i]);
+        }
+        simulator.tick();
+    }
+    return {state.getScore(), state.getPiecesPlaced()};
+}
+
+// Plays every (genome, game) pair, spread over the pool, and sets each genome's fitness
+// to its mean score. Game g uses seed seedBase + g for every genome. Returns the pieces
+// placed in total.
+long long evaluate(std::vector<Genome>& population, const TuneOptions& options, uint64_t seedBase,
+                   WorkerPool* pool) {
+    const int games = options.games;
+    const int jobCount = static_cast<int>(population.size()) * games;
+    std::vector<GameResult> results(jobCount);
+
+    auto play = [&](int job) {
+        results[job] = playGame(toWeights(population[job / games].weights), options, seedBase + job % games);
+    };
+    if (pool) {
+        pool->parallelFor(jobCount, play);
+    } else {
+        for (int job = 0; job < jobCount; ++job) {
+            play(job);
+        }
+    }
+
+    long long pieces = 0;
+    for (int i = 0; i < static_cast<int>(population.size()); ++i) {
+        long long total = 0;
+        for (int game = 0; game < games; ++game) {
+            total += results[i * games + game].score;
+            pieces += results[i * games + game].pieces;
+        }
+        population[i].fitness = static_cast<double>(total) / games;
+    }
+    return pieces;
+}
+
+const Genome& tournament(const std::vector<Genome>& population, Xoshiro256& rng) {
+    int size = std::max(2, static_cast<int>(population.size() * TOURNAMENT_SHARE));
+    const Genome* best = nullptr;
+    for (int i = 0; i < size; ++i) {
+        const Genome& entrant = population[rng.nextBelow(static_cast<uint32_t>(population.size()))];
+        if (!best || entrant.fitness > best->fitness) {
+            best = &entrant;
+        }
+    }
+    return *best;
+}
+
+// `population` must be sorted fittest first. The fittest survive unchanged; the rest
+// are replaced by offspring of tournament winners.
+std::vector<Genome> breed(const std::vector<Genome>& population, Xoshiro256& rng) {
+    const int size = static_cast<int>(population.size());
+    const int offspring = std::max(1, static_cast<int>(size * OFFSPRING_SHARE));
+    std::vector<Genome> next(population.begin(), population.end() - offspring);
+
+    while (static_cast<int>(next.size()) < size) {
+        const Genome& a = tournament(population, rng);
+        const Genome& b = tournament(population, rng);
+        // Scores are never negative; equal zero fitness blends evenly.
+        double total = a.fitness + b.fitness;
+        double share = total > 0 ? a.fitness / total : 0.5;
+
+        Genome child;
+        for (int i = 0; i < WEIGHT_COUNT; ++i) {
+            child.weights[i] = share * a.weights[i] + (1 - share) * b.weights[i];
+        }
+        if (rng.nextDouble() < MUTATION_RATE) {
+            child.weights[rng.nextBelow(WEIGHT_COUNT)] += (rng.nextDouble() * 2 - 1) * MUTATION_STEP;
+        }
+        normalize(child.weights);
+        next.push_back(child);
+    }
+    return next;
+}
+
+void printWeights(const BotWeights& weights) {
+    std::cout << "height " << weights.aggregateHeight << ", lines " << weights.linesCleared
+              << ", holes " << weights.holes << ", bumpiness " << weights.bumpiness;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    TuneOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::vector<Genome> population;
+    int generation = 0;
+    if (options.resume) {
+        if (!loadCheckpoint(options.checkpointPath, options, generation, population)) {
+            std::cerr << "Cannot resume from " << options.checkpointPath << std::endl;
+            return 1;
+        }
+        std::cout << "resumed:     generation " << generation << ", " << population.size() << " genomes" << std::endl;
+    } else {
+        Xoshiro256 rng(options.seed);
+        population = randomPopulation(options.population, rng);
+    }
+
+    // The calling thread plays games too, so the pool gets one worker fewer.
+    int threadCount = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = std::max(1, threadCount);
+    std::unique_ptr<WorkerPool> pool;
+    if (threadCount > 1) {
+        pool = std::make_unique<WorkerPool>(threadCount - 1);
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    const int lastGeneration = generation + options.generations;
+    for (; generation < lastGeneration; ++generation) {
+        // Seeds and choices are functions of (seed, generation) only, so resuming repeats them.
+        Xoshiro256 rng(options.seed ^ (static_cast<uint64_t>(generation) * 0x9E3779B97F4A7C15ull));
+        uint64_t seedBase = rng.next();
+
+        auto start = std::chrono::steady_clock::now();
+        long long pieces = evaluate(population, options, seedBase, pool.get());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::stable_sort(population.begin(), population.end(),
+                         [](const Genome& a, const Genome& b) { return a.fitness > b.fitness; });
+        double mean = 0;
+        for (const Genome& genome : population) {
+            mean += genome.fitness;
+        }
+        mean /= population.size();
+
+        std::cout << "generation " << generation << ": best " << std::setprecision(1) << population[0].fitness
+                  << " mean " << mean << " pts, " << population.size() * options.games << " games in "
+                  << seconds << " s (" << std::setprecision(0) << pieces / seconds << " pieces/sec)"
+                  << std::setprecision(3) << "\n  best weights: ";
+        printWeights(toWeights(population[0].weights));
+        std::cout << std::endl;
+
+        population = breed(population, rng);
+        if (!saveCheckpoint(options.checkpointPath, options, generation + 1, population)) {
+            std::cerr << "Cannot write checkpoint: " << options.checkpointPath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
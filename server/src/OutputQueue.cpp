@@ -0,0 +1,72 @@
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "OutputQueue.h"
+
+OutputQueue::OutputQueue()
+    : offset(0),
+      pendingBytes(0) {
+}
+
+void OutputQueue::push(Buffer buffer) {
+    if (buffer && !buffer->empty()) {
+        pendingBytes += buffer->size();
+        buffers.push_back(std::move(buffer));
+    }
+}
+
+bool OutputQueue::writeTo(int fd) {
+    while (!buffers.empty()) {
+        iovec parts[MAX_IOVECS];
+        int count = 0;
+        std::size_t requested = 0;
+        std::size_t skip = offset;
+        for (auto it = buffers.begin(); it != buffers.end() && count < MAX_IOVECS; ++it) {
+            const std::vector<uint8_t>& buffer = **it;
+            parts[count].iov_base = const_cast<uint8_t*>(buffer.data() + skip);
+            parts[count].iov_len = buffer.size() - skip;
+            requested += parts[count].iov_len;
+            skip = 0;
+            count++;
+        }
+
+        // sendmsg rather than writev, for MSG_NOSIGNAL.
+        msghdr message{};
+        message.msg_iov = parts;
+        message.msg_iovlen = static_cast<std::size_t>(count);
+        ssize_t sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        std::size_t written = static_cast<std::size_t>(sent);
+        std::size_t remaining = written;
+        pendingBytes -= written;
+        while (remaining > 0) {
+            std::size_t left = buffers.front()->size() - offset;
+            if (remaining < left) {
+                offset += remaining;
+                break;
+            }
+            remaining -= left;
+            buffers.pop_front();
+            offset = 0;
+        }
+        if (written < requested) {
+            // The socket buffer is full.
+            return true;
+        }
+    }
+    return true;
+}
+
+void OutputQueue::dropUnsent() {
+    std::size_t keep = offset > 0 ? 1 : 0;
+    while (buffers.size() > keep) {
+        pendingBytes -= buffers.back()->size();
+        buffers.pop_back();
+    }
+}
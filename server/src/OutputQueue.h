@@ -0,0 +1,38 @@
+#ifndef OUTPUT_QUEUE_H
+#define OUTPUT_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// Bytes waiting to go out on one socket. Buffers are immutable and shared, so the same
+// encoded update can sit in thousands of queues at once without being copied; writes
+// gather straight from them.
+class OutputQueue {
+public:
+    using Buffer = std::shared_ptr<const std::vector<uint8_t>>;
+
+    OutputQueue();
+
+    void push(Buffer buffer);
+    // Writes as much as the socket takes without blocking. Returns false on a socket error.
+    bool writeTo(int fd);
+    // Drops every buffer not yet started. A partly written one stays, so the stream
+    // remains frame aligned.
+    void dropUnsent();
+
+    bool isEmpty() const { return buffers.empty(); }
+    std::size_t getPendingBytes() const { return pendingBytes; }
+
+private:
+    static constexpr int MAX_IOVECS = 64;
+
+    std::deque<Buffer> buffers;
+    // Bytes of the front buffer already written.
+    std::size_t offset;
+    std::size_t pendingBytes;
+};
+
+#endif
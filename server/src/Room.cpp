@@ -0,0 +1,103 @@
+#include "Room.h"
+
+Room::Room(uint32_t id, uint64_t seed, uint32_t tickMs)
+    : id(id),
+      seed(seed),
+      tickMs(tickMs),
+      playerCount(0) {
+}
+
+int Room::join() {
+    for (int slot = 0; slot < MAX_PLAYERS; ++slot) {
+        Seat& seat = seats[slot];
+        if (!seat.simulator) {
+            seat.simulator = std::make_unique<Simulator>(tickMs, seed);
+            seat.encoder = SnapshotEncoder();
+            seat.encoder.capture(seat.simulator->getState(), 0);
+            seat.changed = true;
+            seat.broadcastGeneration = 0;
+            playerCount++;
+            return slot;
+        }
+    }
+    return -1;
+}
+
+void Room::leave(int slot) {
+    if (slot < 0 || slot >= MAX_PLAYERS || !seats[slot].simulator) {
+        return;
+    }
+    seats[slot].simulator.reset();
+    seats[slot].changed = false;
+    playerCount--;
+}
+
+void Room::apply(int slot, Command command) {
+    Seat& seat = seats[slot];
+    if (seat.simulator) {
+        seat.simulator->apply(command);
+    }
+}
+
+void Room::tick(int count) {
+    for (Seat& seat : seats) {
+        if (seat.simulator) {
+            seat.simulator->tick(count);
+            const Simulator& simulator = *seat.simulator;
+            if (seat.encoder.capture(simulator.getState(), simulator.getTickCount())) {
+                seat.changed = true;
+            }
+        }
+    }
+}
+
+bool Room::hasChanges() const {
+    for (const Seat& seat : seats) {
+        if (seat.changed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Room::encodeUpdates(std::vector<uint8_t>& out, const uint32_t* acked) const {
+    for (int slot = 0; slot < MAX_PLAYERS; ++slot) {
+        const Seat& seat = seats[slot];
+        if (seat.simulator && seat.changed) {
+            seat.encoder.encode(out, static_cast<uint8_t>(slot), acked[slot]);
+        }
+    }
+}
+
+void Room::encodeBroadcast(std::vector<uint8_t>& out) {
+    for (int slot = 0; slot < MAX_PLAYERS; ++slot) {
+        Seat& seat = seats[slot];
+        if (seat.simulator && seat.changed) {
+            seat.encoder.encode(out, static_cast<uint8_t>(slot), seat.broadcastGeneration);
+            seat.broadcastGeneration = seat.encoder.getGeneration();
+        }
+    }
+}
+
+void Room::skipBroadcast() {
+    for (Seat& seat : seats) {
+        if (seat.simulator && seat.changed) {
+            seat.broadcastGeneration = seat.encoder.getGeneration();
+        }
+    }
+}
+
+void Room::clearChanges() {
+    for (Seat& seat : seats) {
+        seat.changed = false;
+    }
+}
+
+void Room::encodeAll(std::vector<uint8_t>& out) const {
+    for (int slot = 0; slot < MAX_PLAYERS; ++slot) {
+        const Seat& seat = seats[slot];
+        if (seat.simulator) {
+            seat.encoder.encodeKeyframe(out, static_cast<uint8_t>(slot));
+        }
+    }
+}
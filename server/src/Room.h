@@ -0,0 +1,62 @@
+#ifndef ROOM_H
+#define ROOM_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Command.h"
+#include "Simulator.h"
+#include "Snapshot.h"
+
+// One match on the server: up to MAX_PLAYERS boards, all drawing the same piece sequence
+// and all advanced by the same server tick. Knows nothing about sockets.
+class Room {
+public:
+    static constexpr int MAX_PLAYERS = 4;
+
+    Room(uint32_t id, uint64_t seed, uint32_t tickMs);
+
+    uint32_t getId() const { return id; }
+    uint64_t getSeed() const { return seed; }
+    int getPlayerCount() const { return playerCount; }
+    bool isEmpty() const { return playerCount == 0; }
+    bool isFull() const { return playerCount == MAX_PLAYERS; }
+
+    // Returns the new player's slot, or -1 when the room is full.
+    int join();
+    void leave(int slot);
+    void apply(int slot, Command command);
+    // Advances every board and captures a snapshot of each one that changed.
+    void tick(int count);
+
+    bool hasChanges() const;
+    // Appends a Keyframe or Delta for every board changed in the last tick, relative to
+    // what the recipient acknowledged (`acked` is indexed by slot).
+    void encodeUpdates(std::vector<uint8_t>& out, const uint32_t* acked) const;
+    // Appends the changes of the last tick as one chain of deltas, each against the
+    // generation the previous broadcast carried. Spectators do not acknowledge, so they all
+    // get these same bytes and stay in step as long as they miss none of them.
+    void encodeBroadcast(std::vector<uint8_t>& out);
+    // Moves the broadcast chain on without encoding anything, while nobody is watching.
+    void skipBroadcast();
+    void clearChanges();
+    // Appends a keyframe of every board, for anyone who just joined or fell behind.
+    void encodeAll(std::vector<uint8_t>& out) const;
+
+private:
+    struct Seat {
+        std::unique_ptr<Simulator> simulator;
+        SnapshotEncoder encoder;
+        bool changed = false;
+        uint32_t broadcastGeneration = 0;
+    };
+
+    uint32_t id;
+    uint64_t seed;
+    uint32_t tickMs;
+    int playerCount;
+    std::array<Seat, MAX_PLAYERS> seats;
+};
+
+#endif
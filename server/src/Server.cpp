@@ -0,0 +1,464 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Server.h"
+
+namespace {
+
+// Thousands of sessions need more descriptors than the usual soft limit of 1024.
+void raiseDescriptorLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+}
+
+Server::Server(uint32_t tickMs)
+    : tickMs(tickMs),
+      listenFd(-1),
+      epollFd(-1),
+      running(false),
+      framesIn(0),
+      bytesOut(0),
+      bytesEncoded(0),
+      spectatorCount(0) {
+    std::random_device entropy;
+    seeds.seedWith((static_cast<uint64_t>(entropy()) << 32) | entropy());
+}
+
+Server::~Server() {
+    for (auto& entry : sessions) {
+        close(entry.first);
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+bool Server::listen(uint16_t port) {
+    raiseDescriptorLimit();
+
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (listenFd < 0) {
+        std::cerr << "socket failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "bind to port " << port << " failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (::listen(listenFd, SOMAXCONN) != 0) {
+        std::cerr << "listen failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    epollFd = epoll_create1(0);
+    if (epollFd < 0) {
+        std::cerr << "epoll_create1 failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) == 0;
+}
+
+// The loop sleeps in epoll_wait until either a socket is ready or the next tick is due.
+// Ticks missed while busy are simulated together rather than dropped.
+void Server::run() {
+    running = true;
+    nextTick = Clock::now();
+    lastReport = nextTick;
+    const Clock::duration tickPeriod = std::chrono::milliseconds(tickMs);
+
+    epoll_event events[MAX_EVENTS];
+    while (running) {
+        auto wait = std::chrono::ceil<std::chrono::milliseconds>(nextTick - Clock::now());
+        int timeout = static_cast<int>(std::max<long long>(0, wait.count()));
+
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, timeout);
+        if (count < 0 && errno != EINTR) {
+            std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptSessions();
+                continue;
+            }
+
+            auto found = sessions.find(fd);
+            if (found == sessions.end()) {
+                continue;
+            }
+            Session& session = *found->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeSession(session);
+                continue;
+            }
+            if ((events[i].events & EPOLLOUT) && !session.closing) {
+                flush(session);
+            }
+            if ((events[i].events & EPOLLIN) && !session.closing) {
+                readFrom(session);
+            }
+        }
+        reapSessions();
+
+        Clock::time_point now = Clock::now();
+        if (now >= nextTick) {
+            int due = static_cast<int>((now - nextTick) / tickPeriod) + 1;
+            nextTick += due * tickPeriod;
+            tickRooms(due);
+            reapSessions();
+        }
+        if (now - lastReport >= REPORT_PERIOD) {
+            report(now);
+        }
+    }
+}
+
+void Server::acceptSessions() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "accept failed: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLET;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+
+        auto session = std::make_unique<Session>();
+        session->fd = fd;
+        sessions[fd] = std::move(session);
+    }
+}
+
+// Edge-triggered, so the socket is drained until it would block.
+void Server::readFrom(Session& session) {
+    int fd = session.fd;
+    uint8_t buffer[4096];
+
+    while (true) {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received == 0) {
+            closeSession(session);
+            return;
+        }
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                closeSession(session);
+            }
+            return;
+        }
+
+        session.input.append(buffer, static_cast<std::size_t>(received));
+
+        MessageType type;
+        const uint8_t* payload;
+        std::size_t size;
+        while (!session.closing && session.input.next(type, payload, size)) {
+            framesIn++;
+            if (!handleFrame(session, type, payload, size)) {
+                closeSession(session);
+            }
+        }
+        if (session.input.isCorrupt()) {
+            closeSession(session);
+        }
+        if (session.closing) {
+            return;
+        }
+    }
+}
+
+// Returns false for anything a well-behaved client would never send.
+bool Server::handleFrame(Session& session, MessageType type, const uint8_t* payload, std::size_t size) {
+    switch (type) {
+        case MessageType::Join: {
+            uint32_t roomId;
+            if (!decodeJoin(payload, size, roomId) || session.room) {
+                return false;
+            }
+            joinRoom(session, roomId);
+            return true;
+        }
+        case MessageType::Spectate: {
+            uint32_t roomId;
+            if (!decodeSpectate(payload, size, roomId) || session.room) {
+                return false;
+            }
+            spectateRoom(session, roomId);
+            return true;
+        }
+        case MessageType::Input: {
+            Command command;
+            if (!decodeInput(payload, size, command) || !session.room || session.slot < 0) {
+                return false;
+            }
+            session.room->apply(session.slot, command);
+            return true;
+        }
+        case MessageType::Ack: {
+            uint8_t slot;
+            uint32_t generation;
+            if (!decodeAck(payload, size, slot, generation) || slot >= Room::MAX_PLAYERS) {
+                return false;
+            }
+            session.acked[slot] = generation;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+Server::RoomEntry& Server::findRoom(uint32_t roomId) {
+    RoomEntry& entry = rooms[roomId];
+    if (!entry.room) {
+        entry.room = std::make_unique<Room>(roomId, seeds.next(), tickMs);
+    }
+    return entry;
+}
+
+void Server::joinRoom(Session& session, uint32_t roomId) {
+    RoomEntry& entry = findRoom(roomId);
+    int slot = entry.room->join();
+    if (slot < 0) {
+        // Full: the client sees the connection close without a Welcome.
+        closeSession(session);
+        return;
+    }
+
+    session.room = entry.room.get();
+    session.slot = slot;
+    std::fill(std::begin(session.acked), std::end(session.acked), 0);
+    entry.members[slot] = &session;
+    entry.keyframes.reset();
+
+    std::vector<uint8_t> welcome;
+    encodeWelcome(welcome, {roomId, static_cast<uint8_t>(slot), entry.room->getSeed()});
+    entry.room->encodeAll(welcome);
+    send(session, share(std::move(welcome)));
+}
+
+void Server::spectateRoom(Session& session, uint32_t roomId) {
+    RoomEntry& entry = findRoom(roomId);
+    session.room = entry.room.get();
+    session.slot = -1;
+    session.spectatorIndex = entry.spectators.size();
+    entry.spectators.push_back(&session);
+    spectatorCount++;
+    send(session, getKeyframes(entry));
+}
+
+void Server::leaveRoom(Session& session) {
+    if (!session.room) {
+        return;
+    }
+
+    uint32_t roomId = session.room->getId();
+    RoomEntry& entry = rooms[roomId];
+    session.room = nullptr;
+    if (session.slot < 0) {
+        Session* last = entry.spectators.back();
+        last->spectatorIndex = session.spectatorIndex;
+        entry.spectators[session.spectatorIndex] = last;
+        entry.spectators.pop_back();
+        spectatorCount--;
+        if (entry.room->isEmpty() && entry.spectators.empty()) {
+            rooms.erase(roomId);
+        }
+        return;
+    }
+
+    entry.members[session.slot] = nullptr;
+    entry.keyframes.reset();
+    entry.room->leave(session.slot);
+    // A later player in this slot starts a new generation sequence.
+    for (Session* member : entry.members) {
+        if (member) {
+            member->acked[session.slot] = 0;
+        }
+    }
+    if (entry.room->isEmpty() && entry.spectators.empty()) {
+        rooms.erase(roomId);
+    }
+    session.slot = -1;
+}
+
+OutputQueue::Buffer Server::share(std::vector<uint8_t>&& bytes) {
+    bytesEncoded += bytes.size();
+    return std::make_shared<const std::vector<uint8_t>>(std::move(bytes));
+}
+
+const OutputQueue::Buffer& Server::getKeyframes(RoomEntry& entry) {
+    if (!entry.keyframes) {
+        std::vector<uint8_t> bytes;
+        encodeWelcome(bytes, {entry.room->getId(), SPECTATOR_SLOT, entry.room->getSeed()});
+        entry.room->encodeAll(bytes);
+        entry.keyframes = share(std::move(bytes));
+    }
+    return entry.keyframes;
+}
+
+void Server::send(Session& session, const OutputQueue::Buffer& buffer) {
+    if (session.output.getPendingBytes() + buffer->size() > MAX_PENDING_OUTPUT) {
+        std::cerr << "dropping session " << session.fd << ": client is not reading" << std::endl;
+        closeSession(session);
+        return;
+    }
+    if (session.closing) {
+        return;
+    }
+    session.output.push(buffer);
+    bytesOut += buffer->size();
+    if (!session.waitingForWrite) {
+        flush(session);
+    }
+}
+
+// Writes as much pending output as the socket takes; waits for EPOLLOUT for the rest.
+void Server::flush(Session& session) {
+    if (!session.output.writeTo(session.fd)) {
+        closeSession(session);
+        return;
+    }
+
+    bool pending = !session.output.isEmpty();
+    if (pending != session.waitingForWrite) {
+        session.waitingForWrite = pending;
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLET | (pending ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        event.data.fd = session.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, session.fd, &event);
+    }
+}
+
+// Takes the session out of its room at once but leaves the object alive until
+// reapSessions(), since callers may still be holding it.
+void Server::closeSession(Session& session) {
+    if (session.closing) {
+        return;
+    }
+    session.closing = true;
+    closingSessions.push_back(session.fd);
+}
+
+void Server::reapSessions() {
+    for (int fd : closingSessions) {
+        auto found = sessions.find(fd);
+        if (found == sessions.end()) {
+            continue;
+        }
+        leaveRoom(*found->second);
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        sessions.erase(found);
+    }
+    closingSessions.clear();
+}
+
+// Advances every room and sends each changed board to every player in that room, encoded
+// against what each of them has acknowledged, then to its spectators.
+void Server::tickRooms(int count) {
+    for (auto& pair : rooms) {
+        RoomEntry& entry = pair.second;
+        entry.room->tick(count);
+        if (!entry.room->hasChanges()) {
+            continue;
+        }
+        entry.keyframes.reset();
+
+        for (Session* member : entry.members) {
+            if (member) {
+                std::vector<uint8_t> update;
+                entry.room->encodeUpdates(update, member->acked);
+                if (!update.empty()) {
+                    send(*member, share(std::move(update)));
+                }
+            }
+        }
+        broadcast(entry);
+        entry.room->clearChanges();
+    }
+}
+
+// The update is encoded once and the same buffer is queued to every spectator. One who
+// has fallen behind drops what is still queued and takes the latest keyframes instead,
+// after which the shared deltas apply again.
+void Server::broadcast(RoomEntry& entry) {
+    if (entry.spectators.empty()) {
+        entry.room->skipBroadcast();
+        return;
+    }
+
+    std::vector<uint8_t> bytes;
+    entry.room->encodeBroadcast(bytes);
+    if (bytes.empty()) {
+        return;
+    }
+    OutputQueue::Buffer update = share(std::move(bytes));
+
+    for (Session* spectator : entry.spectators) {
+        if (spectator->output.getPendingBytes() > SPECTATOR_LAG_LIMIT) {
+            spectator->output.dropUnsent();
+            send(*spectator, getKeyframes(entry));
+        } else {
+            send(*spectator, update);
+        }
+    }
+}
+
+void Server::report(Clock::time_point now) {
+    double seconds = std::chrono::duration<double>(now - lastReport).count();
+    std::cout << "sessions: " << sessions.size() << "  spectators: " << spectatorCount
+              << "  rooms: " << rooms.size()
+              << "  frames in/s: " << static_cast<uint64_t>(framesIn / seconds)
+              << "  KiB encoded/s: " << static_cast<uint64_t>(bytesEncoded / seconds / 1024)
+              << "  KiB out/s: " << static_cast<uint64_t>(bytesOut / seconds / 1024) << std::endl;
+    framesIn = 0;
+    bytesOut = 0;
+    bytesEncoded = 0;
+    lastReport = now;
+}
@@ -0,0 +1,106 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "OutputQueue.h"
+#include "Protocol.h"
+#include "Random.h"
+#include "Room.h"
+
+// Authoritative game server: one thread, one epoll loop, any number of rooms. Players
+// only send commands; every board is simulated here and pushed back as keyframes and
+// deltas. Any number of spectators can watch a room; they share one encoded stream.
+class Server {
+public:
+    static constexpr uint16_t DEFAULT_PORT = 7777;
+    static constexpr uint32_t DEFAULT_TICK_MS = 16;
+
+    explicit Server(uint32_t tickMs = DEFAULT_TICK_MS);
+    ~Server();
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    bool listen(uint16_t port);
+    // Serves until stop(); safe to call stop() from a signal handler.
+    void run();
+    void stop() { running = false; }
+
+    std::size_t getSessionCount() const { return sessions.size(); }
+    std::size_t getRoomCount() const { return rooms.size(); }
+    std::size_t getSpectatorCount() const { return spectatorCount; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Output beyond this means the client stopped reading; it is disconnected.
+    static constexpr std::size_t MAX_PENDING_OUTPUT = 256 * 1024;
+    // A spectator this far behind skips the backlog and resumes from a keyframe.
+    static constexpr std::size_t SPECTATOR_LAG_LIMIT = 16 * 1024;
+    static constexpr int MAX_EVENTS = 256;
+    static constexpr std::chrono::seconds REPORT_PERIOD{5};
+
+    struct Session {
+        int fd = -1;
+        FrameParser input;
+        OutputQueue output;
+        bool waitingForWrite = false;
+        Room* room = nullptr;
+        // -1 for a spectator.
+        int slot = -1;
+        std::size_t spectatorIndex = 0;
+        // Newest generation of each board in the room that the client has confirmed.
+        uint32_t acked[Room::MAX_PLAYERS] = {};
+        bool closing = false;
+    };
+
+    struct RoomEntry {
+        std::unique_ptr<Room> room;
+        Session* members[Room::MAX_PLAYERS] = {};
+        std::vector<Session*> spectators;
+        // Welcome plus keyframes of every board, shared by all spectators; rebuilt on
+        // demand after the room changes.
+        OutputQueue::Buffer keyframes;
+    };
+
+    uint32_t tickMs;
+    int listenFd;
+    int epollFd;
+    std::atomic<bool> running;
+    Xoshiro256 seeds;
+
+    std::unordered_map<int, std::unique_ptr<Session>> sessions;
+    std::unordered_map<uint32_t, RoomEntry> rooms;
+    // Sessions are only destroyed between loop iterations, never while in use.
+    std::vector<int> closingSessions;
+
+    Clock::time_point nextTick;
+    Clock::time_point lastReport;
+    uint64_t framesIn;
+    uint64_t bytesOut;
+    uint64_t bytesEncoded;
+    std::size_t spectatorCount;
+
+    void acceptSessions();
+    void readFrom(Session& session);
+    bool handleFrame(Session& session, MessageType type, const uint8_t* payload, std::size_t size);
+    RoomEntry& findRoom(uint32_t roomId);
+    void joinRoom(Session& session, uint32_t roomId);
+    void spectateRoom(Session& session, uint32_t roomId);
+    void leaveRoom(Session& session);
+    OutputQueue::Buffer share(std::vector<uint8_t>&& bytes);
+    const OutputQueue::Buffer& getKeyframes(RoomEntry& entry);
+    void send(Session& session, const OutputQueue::Buffer& buffer);
+    void flush(Session& session);
+    void closeSession(Session& session);
+    void reapSessions();
+    void tickRooms(int count);
+    void broadcast(RoomEntry& entry);
+    void report(Clock::time_point now);
+};
+
+#endif
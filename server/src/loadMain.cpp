@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Protocol.h"
+#include "Random.h"
+#include "Snapshot.h"
+
+// Usage:
+//   tetris_load [--host ADDR] [--port N] [--clients N] [--per-room N] [--rate N] [--seconds N]
+//               [--spectators N]
+//
+// Opens --clients connections to a tetris_server, --per-room of them sharing each room,
+// and has every client send --rate random commands per second. Reports how many sessions
+// are connected and the keyframes and deltas received per second. Clients decode and
+// acknowledge every board like the real client does, so the server sends real deltas.
+// --spectators more connections watch those rooms, spread evenly, and count every update
+// they could not decode.
+
+namespace {
+
+struct LoadOptions {
+    std::string host = "127.0.0.1";
+    uint16_t port = 7777;
+    int clients = 1000;
+    int perRoom = 2;
+    double rate = 4.0;
+    int seconds = 10;
+    int spectators = 0;
+};
+
+struct Client {
+    int fd = -1;
+    bool connected = false;
+    bool welcomed = false;
+    bool spectator = false;
+    FrameParser input;
+    std::vector<SnapshotDecoder> boards;
+    std::chrono::steady_clock::time_point nextInput;
+};
+
+const Command RANDOM_COMMANDS[] = {Command::Left, Command::Right, Command::Down, Command::Rotate, Command::HardDrop};
+
+bool parseOptions(int argc, char* argv[], LoadOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        if (arg == "--host") {
+            options.host = argv[++i];
+        } else if (arg == "--port") {
+            options.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (arg == "--clients") {
+            options.clients = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--per-room") {
+            options.perRoom = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--rate") {
+            options.rate = std::atof(argv[++i]);
+        } else if (arg == "--seconds") {
+            options.seconds = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--spectators") {
+            options.spectators = std::max(0, std::atoi(argv[++i]));
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void raiseDescriptorLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+// Commands are tiny, so a send that does not complete at once is simply dropped.
+void sendFrame(Client& client, const std::vector<uint8_t>& frame) {
+    ::send(client.fd, frame.data(), frame.size(), MSG_NOSIGNAL);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: tetris_load [--host ADDR] [--port N] [--clients N] [--per-room N] [--rate N] [--seconds N]"
+                     " [--spectators N]" << std::endl;
+        return 1;
+    }
+    raiseDescriptorLimit();
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    if (inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) {
+        std::cerr << "Invalid address: " << options.host << std::endl;
+        return 1;
+    }
+
+    int epollFd = epoll_create1(0);
+    const uint32_t roomCount = static_cast<uint32_t>((options.clients + options.perRoom - 1) / options.perRoom);
+    std::vector<Client> clients(options.clients + options.spectators);
+    for (int i = 0; i < static_cast<int>(clients.size()); ++i) {
+        Client& client = clients[i];
+        client.spectator = i >= options.clients;
+        client.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (client.fd < 0) {
+            std::cerr << "socket failed after " << i << " clients: " << std::strerror(errno) << std::endl;
+            clients.resize(i);
+            break;
+        }
+        int noDelay = 1;
+        setsockopt(client.fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        connect(client.fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT;
+        event.data.u32 = static_cast<uint32_t>(i);
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, client.fd, &event);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    Xoshiro256 random(12345);
+    const auto inputPeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(0.01, options.rate)));
+
+    uint64_t keyframes = 0;
+    uint64_t deltas = 0;
+    uint64_t spectatorUpdates = 0;
+    uint64_t undecodable = 0;
+    uint64_t bytesIn = 0;
+    uint64_t commands = 0;
+    int failed = 0;
+    auto start = Clock::now();
+    auto end = start + std::chrono::seconds(options.seconds);
+    auto lastReport = start;
+    std::vector<uint8_t> frame;
+    std::vector<epoll_event> events(1024);
+    uint8_t buffer[4096];
+
+    auto drop = [&](Client& client) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, client.fd, nullptr);
+        close(client.fd);
+        client.fd = -1;
+        failed++;
+    };
+
+    while (Clock::now() < end) {
+        int count = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 5);
+        for (int e = 0; e < count; ++e) {
+            Client& client = clients[events[e].data.u32];
+
+            if (events[e].events & (EPOLLERR | EPOLLHUP)) {
+                drop(client);
+                continue;
+            }
+
+            if (!client.connected && (events[e].events & EPOLLOUT)) {
+                client.connected = true;
+                epoll_event event{};
+                event.events = EPOLLIN;
+                event.data.u32 = events[e].data.u32;
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, client.fd, &event);
+
+                frame.clear();
+                uint32_t index = events[e].data.u32;
+                if (client.spectator) {
+                    encodeSpectate(frame, (index - static_cast<uint32_t>(options.clients)) % roomCount);
+                } else {
+                    encodeJoin(frame, index / static_cast<uint32_t>(options.perRoom));
+                }
+                sendFrame(client, frame);
+                client.nextInput = Clock::now() + std::chrono::duration_cast<Clock::duration>(inputPeriod * random.nextDouble());
+            }
+
+            if (events[e].events & EPOLLIN) {
+                ssize_t received;
+                while ((received = recv(client.fd, buffer, sizeof(buffer), 0)) > 0) {
+                    bytesIn += static_cast<uint64_t>(received);
+                    client.input.append(buffer, static_cast<std::size_t>(received));
+                    MessageType type;
+                    const uint8_t* payload;
+                    std::size_t size;
+                    frame.clear();
+                    while (client.input.next(type, payload, size)) {
+                        if (type == MessageType::Welcome) {
+                            client.welcomed = true;
+                        } else if ((type == MessageType::Keyframe || type == MessageType::Delta) && size > 0) {
+                            if (client.spectator) {
+                                spectatorUpdates++;
+                            } else {
+                                (type == MessageType::Keyframe ? keyframes : deltas)++;
+                            }
+                            if (payload[0] >= client.boards.size()) {
+                                client.boards.resize(payload[0] + 1);
+                            }
+                            SnapshotDecoder& board = client.boards[payload[0]];
+                            if (!board.apply(type, payload, size)) {
+                                undecodable++;
+                            } else if (!client.spectator) {
+                                encodeAck(frame, payload[0], board.getGeneration());
+                            }
+                        }
+                    }
+                    if (!frame.empty()) {
+                        sendFrame(client, frame);
+                    }
+                }
+                // A closed or failed connection stays readable and would be polled forever.
+                if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                    drop(client);
+                }
+            }
+        }
+
+        auto now = Clock::now();
+        for (Client& client : clients) {
+            if (client.fd >= 0 && client.welcomed && !client.spectator && now >= client.nextInput) {
+                frame.clear();
+                encodeInput(frame, RANDOM_COMMANDS[random.nextBelow(5)]);
+                sendFrame(client, frame);
+                commands++;
+                client.nextInput += inputPeriod;
+                if (client.nextInput < now) {
+                    client.nextInput = now + inputPeriod;
+                }
+            }
+        }
+
+        if (now - lastReport >= std::chrono::seconds(1)) {
+            double seconds = std::chrono::duration<double>(now - lastReport).count();
+            int welcomed = 0;
+            for (const Client& client : clients) {
+                welcomed += client.welcomed && client.fd >= 0 ? 1 : 0;
+            }
+            std::cout << "sessions: " << welcomed << "/" << clients.size()
+                      << "  failed: " << failed
+                      << "  commands/s: " << static_cast<uint64_t>(commands / seconds)
+                      << "  keyframes/s: " << static_cast<uint64_t>(keyframes / seconds)
+                      << "  deltas/s: " << static_cast<uint64_t>(deltas / seconds)
+                      << "  spectator updates/s: " << static_cast<uint64_t>(spectatorUpdates / seconds)
+                      << "  undecodable: " << undecodable
+                      << "  KiB in/s: " << static_cast<uint64_t>(bytesIn / seconds / 1024) << std::endl;
+            keyframes = 0;
+            deltas = 0;
+            spectatorUpdates = 0;
+            undecodable = 0;
+            bytesIn = 0;
+            commands = 0;
+            lastReport = now;
+        }
+    }
+
+    for (Client& client : clients) {
+        if (client.fd >= 0) {
+            close(client.fd);
+        }
+    }
+    close(epollFd);
+    return 0;
+}
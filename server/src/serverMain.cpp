@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "Server.h"
+
+// Usage:
+//   tetris_server [--port N] [--tick-ms N]
+//
+// Hosts rooms for networked games until interrupted. Clients join a room by number; the
+// first Join creates it and the room goes away when its last player leaves.
+
+namespace {
+
+Server* activeServer = nullptr;
+
+void handleSignal(int) {
+    if (activeServer) {
+        activeServer->stop();
+    }
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    uint16_t port = Server::DEFAULT_PORT;
+    uint32_t tickMs = Server::DEFAULT_TICK_MS;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--port" && i + 1 < argc) {
+            port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (arg == "--tick-ms" && i + 1 < argc) {
+            tickMs = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        } else {
+            std::cerr << "Usage: tetris_server [--port N] [--tick-ms N]" << std::endl;
+            return 1;
+        }
+    }
+
+    Server server(tickMs);
+    if (!server.listen(port)) {
+        return 1;
+    }
+
+    activeServer = &server;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    std::cout << "tetris_server listening on port " << port << std::endl;
+    server.run();
+    activeServer = nullptr;
+    return 0;
+}